@@ -3,225 +3,587 @@
 #include "ns3/mobility-module.h"
 #include "ns3/wifi-module.h"
 #include "ns3/internet-module.h"
-#include <map>
 #include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "checkpoint.h"
+#include "data-aggregator.h"
+#include "distributed.h"
+#include "energy-trace-writer.h"
+#include "event-recorder.h"
+#include "lifetime-statistics.h"
+#include "parameter-sweep.h"
+#include "profiler.h"
+#include "protocol-engine.h"
+#include "replication-runner.h"
+#include "simulation-config.h"
+#include "tick-group.h"
 
 using namespace ns3;
 using namespace ns3::energy;
 
 NS_LOG_COMPONENT_DEFINE("LeachDmsNetworkSimulation");
 
-// Cluster structure and function declarations
-struct Cluster {
-    Ptr<Node> clusterHead;
-    std::vector<Ptr<Node>> members;
-};
-
-std::map<uint32_t, Cluster> clusters;
-std::map<uint32_t, double> nodeEnergyLevels;
-double clusterHeadProbability = 0.2;
-double initialEnergy = 100.0;
-
-void ClearClusters();
-void ElectClusterHeads(NodeContainer nodes);
-void FormClusters(NodeContainer nodes);
-void SetupClusterCommunications(NodeContainer nodes, Ptr<Node> baseStation);
-void ScheduleClusterFormation(NodeContainer nodes);
-void IntraClusterCommunication(Ptr<Node> memberNode, Ptr<Node> clusterHead);
-void InterClusterCommunication(Ptr<Node> clusterHead, Ptr<Node> baseStation);
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices);
-void InitializeNodeEnergyLevels(NodeContainer nodes);
+leach::SimulationConfig config; // Node count, field, p, duration, energy and policies from the command line
+leach::ProtocolEngine engine(config); // Node setup, energy, election, formation and DMS power
+leach::NodeStateTable& nodeState = engine.GetState(); // Per-node energy, role and cluster membership
+std::vector<leach::Cluster>& clusters = engine.GetClusters(); // Clusters of the current round, in election order
+leach::TickGroup frameTicks(leach::EVENT_CLUSTER_FRAME); // Serving heads, all framed by one event per frame
+leach::DataAggregator aggregator; // Member readings buffered at each head until the frame's uplink
+leach::EnergyTraceWriter energyTrace; // Buffered binary (time, node, energy) samples
+leach::RunSummary runSummary; // First node death, energy curve and head counts of this run
+leach::LifetimeStatistics lifetime; // Death milestones, head counts and residual energy in fixed memory
+const double roundLength = 20.0; // Seconds between elections; the first is at roundLength
+const double energyReportInterval = 100.0; // Seconds between energy reports; the first is at 0
+std::string checkpointSavePath; // Snapshot the run here at checkpointAt (empty to skip)
+double checkpointAt = 0.0; // Simulated second of the snapshot
+std::string checkpointRestorePath; // Resume from this checkpoint instead of running the warm-up
+double timeOffset = 0.0; // Run time minus simulator time: a restored warm-up, less earlier sweep points
+EventId reportEvent; // Next periodic energy report
+EventId saveEvent; // Pending checkpoint
+EventId stopEvent; // End of the current run or sweep point
+EventId roundEvents[4]; // Next round's election, formation, setup and rescheduling
+EventId retireEvent; // Pending RetireDeadNodes
+std::vector<uint32_t> deadNodes; // Emptied this instant; they leave their clusters once the current event is done
+uint32_t uplinkCount = 0; // Fused uplinks sent this run; every 5th is recorded
+
+void ElectClusterHeads();
+void FormClustersBruteForce(const leach::NodeRegistry& nodes);
+void SetupClusterCommunications();
+void ScheduleRound(Time delay);
+void ScheduleClusterFormation();
+void StartFrames();
+void InterClusterCommunication(uint32_t headId);
+void ClusterFrame(uint32_t headId);
 void UpdateEnergy(uint32_t nodeId, double energyUsed);
-double CalculateTransmissionPower(double distance);
-void SetMobility(NodeContainer nodes);
+void RecordDeath(uint32_t nodeId, double energyBefore);
+void RetireDeadNodes();
 void LogPeriodicEnergyLevels();
-
-void InitializeNodeEnergyLevels(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        nodeEnergyLevels[node->GetId()] = initialEnergy;
-    }
+void SaveCheckpoint();
+void ResumeSchedule(double checkpointTime, bool framesRunning);
+void RunFormationBenchmark(uint32_t numNodes, uint32_t repetitions);
+void BuildNetwork();
+void CancelPeriodicEvents();
+leach::RunSummary RunProtocol(uint64_t run);
+leach::RunSummary RunSimulation(uint64_t run);
+void RunSweep(const leach::ParameterSweep& sweep, uint64_t run, std::ostream& out, bool header);
+
+// Simulated seconds since the start of the run, including a restored warm-up
+double SimulationTime() {
+    return Simulator::Now().GetSeconds() + timeOffset;
 }
 
+// Charge a node and record the run's first node death
 void UpdateEnergy(uint32_t nodeId, double energyUsed) {
-    if (nodeEnergyLevels.find(nodeId) != nodeEnergyLevels.end()) {
-        nodeEnergyLevels[nodeId] = std::max(0.0, nodeEnergyLevels[nodeId] - energyUsed);
+    if (nodeId < nodeState.GetN()) {
+        double energyBefore = nodeState.energy[nodeId];
+        engine.UpdateEnergy(nodeId, energyUsed);
+        RecordDeath(nodeId, energyBefore);
     }
 }
 
-double CalculateTransmissionPower(double distance) {
-    double basePower = 1.0;
-    if (distance > 50.0) {
-        return basePower * 1.5;
-    } else if (distance > 20.0) {
-        return basePower * 1.2;
-    } else {
-        return basePower * 0.8;
+// Count a node that the last charge emptied. It can no longer be elected or
+// join a cluster; it leaves its current one right after this event, since the
+// charge may be in the middle of walking that cluster or the frame ticks.
+void RecordDeath(uint32_t nodeId, double energyBefore) {
+    if (energyBefore > 0.0 && nodeState.energy[nodeId] == 0.0) {
+        if (runSummary.firstNodeDeathTime < 0.0) {
+            runSummary.firstNodeDeathTime = SimulationTime();
+        }
+        nodeState.alive[nodeId] = 0;
+        leach::EventRecorder::Get().Record(leach::RECORD_NODE_FAILED, nodeId);
+        if (deadNodes.empty()) {
+            retireEvent = Simulator::ScheduleNow(leach::Profiled(leach::EVENT_CHECK_NODE_FAILURE, &RetireDeadNodes));
+        }
+        deadNodes.push_back(nodeId);
+        lifetime.OnNodeDeath(SimulationTime()); // May stop the run after this event
     }
 }
 
-void ClearClusters() {
-    clusters.clear();
-}
-
-void ElectClusterHeads(NodeContainer nodes) {
-    ClearClusters();
-    NS_LOG_INFO("Starting a new round of cluster head elections...");
-    bool anyClusterHeadElected = false;
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        
-        if ((double)rand() / RAND_MAX <= clusterHeadProbability && nodeEnergyLevels[node->GetId()] > 10.0) {
-            Cluster newCluster;
-            newCluster.clusterHead = node;
-            clusters[node->GetId()] = newCluster;
-            NS_LOG_INFO("Node " << node->GetId() << " elected as cluster head with energy: " 
-                                << nodeEnergyLevels[node->GetId()]);
-            anyClusterHeadElected = true;
+// Take dead nodes out of their clusters, as customexample3's failure check does
+void RetireDeadNodes() {
+    for (uint32_t nodeId : deadNodes) {
+        if (nodeState.IsClusterHead(nodeId)) {
+            uint32_t cluster = nodeState.clusterIndex[nodeId];
+            frameTicks.Remove(nodeId);
+            if (engine.PromoteBackupHead(nodeId)) {
+                frameTicks.Add(clusters[cluster].clusterHead); // The successor frames from the next tick
+            } else {
+                engine.RepairCluster(nodeId);
+            }
+        } else if (nodeState.role[nodeId] == leach::ROLE_MEMBER) {
+            engine.RemoveMember(nodeId);
         }
     }
-    if (!anyClusterHeadElected) {
-        NS_LOG_INFO("No cluster heads elected this round.");
-    }
+    deadNodes.clear();
 }
 
+// Under MPI each rank elects its own region's heads; the count covers the whole field
+void ElectClusterHeads() {
+    engine.ElectClusterHeads();
+    uint32_t heads = static_cast<uint32_t>(leach::AllReduceSum(clusters.size()));
+    runSummary.clusterHeadCounts.push_back(heads);
+    lifetime.OnRound(heads);
+}
 
-void FormClusters(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        if (clusters.find(node->GetId()) == clusters.end()) {
+// Original O(N*K) scan over every cluster head, kept for --benchmarkFormation
+void FormClustersBruteForce(const leach::NodeRegistry& nodes) {
+    for (uint32_t nodeId = 0; nodeId < nodes.GetN(); ++nodeId) {
+        if (!nodeState.IsClusterHead(nodeId)) {
+            Ptr<MobilityModel> position = nodes.Get(nodeId)->GetObject<MobilityModel>();
             double minDistance = std::numeric_limits<double>::max();
-            Ptr<Node> closestClusterHead = nullptr;
+            uint32_t closestClusterHead = leach::NodeStateTable::kNone;
             
-            for (auto& entry : clusters) {
-                Ptr<Node> clusterHead = entry.second.clusterHead;
-                double distance = node->GetObject<MobilityModel>()->GetDistanceFrom(clusterHead->GetObject<MobilityModel>());
+            for (const leach::Cluster& cluster : clusters) {
+                double distance = position->GetDistanceFrom(nodes.Get(cluster.clusterHead)->GetObject<MobilityModel>());
                 
                 if (distance < minDistance) {
                     minDistance = distance;
-                    closestClusterHead = clusterHead;
+                    closestClusterHead = cluster.clusterHead;
                 }
             }
             
-            if (closestClusterHead) {
-                clusters[closestClusterHead->GetId()].members.push_back(node);
-                NS_LOG_INFO("Node " << node->GetId() << " joined cluster with head " << closestClusterHead->GetId());
+            if (closestClusterHead != leach::NodeStateTable::kNone) {
+                clusters[nodeState.clusterIndex[closestClusterHead]].members.push_back(nodeId);
+                nodeState.AssignMember(nodeId, closestClusterHead);
+                leach::EventRecorder::Get().Record(leach::RECORD_MEMBER_JOINED, nodeId, closestClusterHead);
             }
         }
     }
 }
 
-void IntraClusterCommunication(Ptr<Node> memberNode, Ptr<Node> clusterHead) {
-    double distance = memberNode->GetObject<MobilityModel>()->GetDistanceFrom(clusterHead->GetObject<MobilityModel>());
-    double txPower = CalculateTransmissionPower(distance);
+// The head's single uplink per frame, charged by the size of the fused packet
+void InterClusterCommunication(uint32_t headId) {
+    uint32_t fusedBytes = aggregator.Fuse(headId);
+    if (fusedBytes == 0) {
+        return;
+    }
 
-    // Deduct energy based on transmission power
-    UpdateEnergy(memberNode->GetId(), 0.1 * txPower);
+    uplinkCount++;
+    if (uplinkCount % 5 == 0) { // Only log every 5th uplink to reduce output
+        leach::EventRecorder::Get().Record(leach::RECORD_HEAD_UPLINK, headId, engine.GetNextHop(headId), fusedBytes);
+    }
 
-    Simulator::Schedule(Seconds(1.0), &IntraClusterCommunication, memberNode, clusterHead);
+    // Every frame's uplink is charged, recorded or not: aggregated size at every hop to the base station
+    engine.ForwardUplink(headId, fusedBytes, config.uplinkCost, &UpdateEnergy);
 }
 
-void InterClusterCommunication(Ptr<Node> clusterHead, Ptr<Node> baseStation) {
-    static int roundCounter = 0;
-    roundCounter++;
-    if (roundCounter % 5 == 0) { // Only log every 5 rounds to reduce output
-        double distance = clusterHead->GetObject<MobilityModel>()->GetDistanceFrom(baseStation->GetObject<MobilityModel>());
-        double txPower = CalculateTransmissionPower(distance);
-
-        NS_LOG_INFO("Cluster Head " << clusterHead->GetId() 
-                    << " sends aggregated data to Base Station with power level: " << txPower);
-
-        // Deduct energy based on transmission power
-        UpdateEnergy(clusterHead->GetId(), 0.2 * txPower);
+// One TDMA frame of a cluster: members report, the head adds its own reading and sends one uplink
+void ClusterFrame(uint32_t headId) {
+    engine.UpdateMobileNodes(); // Re-homes moving members; free while nobody crossed a boundary
+    if (!nodeState.IsClusterHead(headId) || !nodeState.alive[headId]) {
+        return; // A new round is being set up, or the head died relaying earlier in this tick
     }
-    Simulator::Schedule(Seconds(5.0), &InterClusterCommunication, clusterHead, baseStation);
+    // Every member's reading is buffered at the head; the engine charges its
+    // transmission and the head's reception
+    engine.ChargeClusterFrame(headId, config.payloadBytes, 0.1,
+                              [headId](uint32_t, double) { aggregator.Collect(headId, config.payloadBytes); },
+                              &RecordDeath);
+    aggregator.Collect(headId, config.payloadBytes);
+    InterClusterCommunication(headId);
 }
 
-void ScheduleClusterFormation(NodeContainer nodes) {
-    Simulator::Schedule(Seconds(20.0), &ElectClusterHeads, nodes);
-    Simulator::Schedule(Seconds(20.0), &FormClusters, nodes);
-    Simulator::Schedule(Seconds(20.0), &SetupClusterCommunications, nodes, nodes.Get(0));
-    Simulator::Schedule(Seconds(20.0), &ScheduleClusterFormation, nodes);
+// Election, formation and setup of the next round after delay
+void ScheduleRound(Time delay) {
+    roundEvents[0] = Simulator::Schedule(delay, leach::Profiled(leach::EVENT_ELECT_CLUSTER_HEADS, &ElectClusterHeads));
+    roundEvents[1] = Simulator::Schedule(delay, leach::Profiled(leach::EVENT_FORM_CLUSTERS, &leach::ProtocolEngine::FormClusters, &engine));
+    roundEvents[2] = Simulator::Schedule(delay, leach::Profiled(leach::EVENT_SETUP_CLUSTER_COMMUNICATIONS, &SetupClusterCommunications));
+    roundEvents[3] = Simulator::Schedule(delay, leach::Profiled(leach::EVENT_SCHEDULE_CLUSTER_FORMATION, &ScheduleClusterFormation));
 }
 
-void SetupClusterCommunications(NodeContainer nodes, Ptr<Node> baseStation) {
-    for (auto& entry : clusters) {
-        Ptr<Node> clusterHead = entry.second.clusterHead;
-        
-        for (Ptr<Node> member : entry.second.members) {
-            IntraClusterCommunication(member, clusterHead);
-        }
+void ScheduleClusterFormation() {
+    ScheduleRound(Seconds(roundLength));
+}
 
-        InterClusterCommunication(clusterHead, baseStation);
+void SetupClusterCommunications() {
+    engine.SetupUplinks();
+    StartFrames();
+}
+
+// Frame this round's heads; the first frame is now, later rounds join the running tick
+void StartFrames() {
+    frameTicks.Clear();
+    for (const leach::Cluster& cluster : clusters) {
+        frameTicks.Add(cluster.clusterHead);
     }
+    frameTicks.Start();
 }
 
 void LogPeriodicEnergyLevels() {
-    double totalEnergy = 0.0;
-    for (const auto& entry : nodeEnergyLevels) {
-        totalEnergy += entry.second;
+    engine.SyncEnergy();
+    double averageEnergy = engine.GlobalAverageEnergy();
+    runSummary.averageEnergy.push_back(averageEnergy);
+    if (leach::GetRankCount() == 1) { // Other ranks' nodes are stale here
+        lifetime.SampleEnergy(nodeState.energy);
+    }
+    if (energyTrace.IsOpen()) {
+        double now = SimulationTime();
+        for (uint32_t i = 0; i < nodeState.GetN(); ++i) {
+            if (engine.IsLocal(i)) { // Each rank traces the nodes it owns
+                energyTrace.Record(now, i, nodeState.energy[i]);
+            }
+        }
     }
-    double averageEnergy = totalEnergy / nodeEnergyLevels.size();
     NS_LOG_INFO("Average node energy level: " << averageEnergy << " J");
-    Simulator::Schedule(Seconds(100.0), &LogPeriodicEnergyLevels);
+    reportEvent = Simulator::Schedule(Seconds(energyReportInterval), leach::Profiled(leach::EVENT_LOG_ENERGY_LEVELS, &LogPeriodicEnergyLevels));
 }
 
+// Snapshot the run so later runs can start past the warm-up
+void SaveCheckpoint() {
+    leach::Checkpoint checkpoint;
+    engine.SaveCheckpoint(checkpoint);
+    checkpoint.time = SimulationTime();
+    checkpoint.firstDeathTime = runSummary.firstNodeDeathTime;
+    if (!checkpoint.Write(checkpointSavePath)) {
+        NS_FATAL_ERROR("Cannot write checkpoint " << checkpointSavePath);
+    }
+    NS_LOG_INFO("Checkpoint of round " << checkpoint.round << " at " << checkpoint.time << " s written to "
+                << checkpointSavePath);
+}
 
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices) {
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
+// Re-enter the periodic schedule where the checkpointed run left it. Each
+// chain resumes at its first tick at or after the checkpoint, scheduled in the
+// order the original run executes same-time events: report, round, frame.
+void ResumeSchedule(double checkpointTime, bool framesRunning) {
+    auto nextTick = [checkpointTime](double first, double period) {
+        double ticks = std::max(0.0, std::ceil((checkpointTime - first) / period - 1e-9));
+        return Seconds(first + ticks * period - checkpointTime);
+    };
+    reportEvent = Simulator::Schedule(nextTick(0.0, energyReportInterval),
+                                      leach::Profiled(leach::EVENT_LOG_ENERGY_LEVELS, &LogPeriodicEnergyLevels));
+    ScheduleRound(nextTick(roundLength, roundLength));
+    if (framesRunning) {
+        Simulator::Schedule(nextTick(roundLength, config.frameLength), &StartFrames);
+    }
+}
 
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper wifiPhy;
-    wifiPhy.SetChannel(wifiChannel.Create());
 
-    WifiMacHelper wifiMac;
-    wifiMac.SetType("ns3::AdhocWifiMac");
+// Time indexed and brute-force cluster formation on numNodes sensors at the
+// configured density; 0 keeps the configured field as it is
+void RunFormationBenchmark(uint32_t numNodes, uint32_t repetitions) {
+    if (numNodes > 0) {
+        config.fieldSize *= std::sqrt(static_cast<double>(numNodes) / config.numNodes);
+        config.numNodes = numNodes;
+    }
+    numNodes = config.numNodes;
+    engine.CreateNodes();
+    engine.SetupEnergyModel();
+    engine.SetMobility();
+    const leach::NodeRegistry& nodes = engine.GetRegistry();
+    ElectClusterHeads();
+
+    auto clearMembers = []() {
+        for (leach::Cluster& cluster : clusters) {
+            cluster.members.clear();
+        }
+    };
 
-    devices = wifi.Install(wifiPhy, wifiMac, nodes);
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    for (uint32_t r = 0; r < repetitions; ++r) {
+        clearMembers();
+        FormClustersBruteForce(nodes);
+    }
+    double bruteForceSeconds = std::chrono::duration<double>(Clock::now() - start).count();
 
-    InternetStackHelper stack;
-    stack.Install(nodes);
+    std::vector<std::vector<uint32_t>> expected;
+    for (const leach::Cluster& cluster : clusters) {
+        expected.push_back(cluster.members);
+    }
+
+    start = Clock::now();
+    for (uint32_t r = 0; r < repetitions; ++r) {
+        clearMembers();
+        engine.BuildClusterHeadIndex();
+        engine.FormClusters();
+    }
+    double indexedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
 
-    Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    address.Assign(devices);
+    uint32_t mismatchedClusters = 0;
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+        if (clusters[i].members != expected[i]) {
+            mismatchedClusters++;
+        }
+    }
+
+    std::cout << "FormClusters benchmark: " << numNodes << " nodes, " << clusters.size() << " heads, "
+              << repetitions << " repetitions" << std::endl
+              << "  brute force: " << bruteForceSeconds / repetitions << " s/round" << std::endl
+              << "  grid index:  " << indexedSeconds / repetitions << " s/round" << std::endl
+              << "  mismatched clusters: " << mismatchedClusters << std::endl;
 }
 
-void SetMobility(NodeContainer nodes) {
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
-        positionAlloc->Add(Vector(10.0 * i, 10.0 * i, 0.0));
+// Nodes, devices, energy model and positions: everything a sweep builds only once
+void BuildNetwork() {
+    engine.CreateNodes();
+
+    {
+        leach::Profiler::ScopedPhase phase("SetupNodes");
+        engine.SetupNodes();
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetupEnergyModel");
+        engine.SetupEnergyModel();
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetMobility");
+        engine.SetMobility();
     }
-    mobility.SetPositionAllocator(positionAlloc);
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(nodes);
 }
 
-int main(int argc, char *argv[]) {
-    LogComponentEnable("LeachDmsNetworkSimulation", LOG_LEVEL_INFO);
+// Cancel the report, round and frame chains and the pending stop so the next
+// sweep point starts clean
+void CancelPeriodicEvents() {
+    Simulator::Cancel(reportEvent);
+    Simulator::Cancel(saveEvent);
+    Simulator::Cancel(stopEvent); // An early stop at stopDeadFraction leaves it pending
+    Simulator::Cancel(retireEvent);
+    deadNodes.clear();
+    uplinkCount = 0;
+    for (EventId& id : roundEvents) {
+        Simulator::Cancel(id);
+    }
+    frameTicks.Stop();
+}
 
-    NodeContainer sensorNodes;
-    sensorNodes.Create(10);
+// The protocol on an already built network for config.duration from now, or
+// from a restored checkpoint
+leach::RunSummary RunProtocol(uint64_t run) {
+    runSummary = leach::RunSummary();
+    runSummary.run = run;
+    timeOffset = -Simulator::Now().GetSeconds(); // Sweep points run back to back on one clock
 
-    NodeContainer baseStationContainer;
-    baseStationContainer.Create(1);
-    Ptr<Node> baseStation = baseStationContainer.Get(0);
+    leach::Checkpoint checkpoint;
+    if (!checkpointRestorePath.empty() && !checkpoint.Read(checkpointRestorePath)) {
+        NS_FATAL_ERROR("Cannot read checkpoint " << checkpointRestorePath);
+    }
 
-    NetDeviceContainer devices;
-    SetupNodes(sensorNodes, devices);
-    SetMobility(sensorNodes);
+    aggregator.Resize(config.numNodes);
+    aggregator.SetCorrelation(config.aggregationCorrelation);
+    frameTicks.Stop();
+    frameTicks.Resize(config.numNodes);
+    frameTicks.SetPeriod(config.frameLength);
+    frameTicks.SetCallback(MakeCallback(&ClusterFrame));
+    lifetime.Reset(config.numNodes, config.initialEnergy, config.stopDeadFraction);
+
+    // Scheduled first so it sees the state before any other event at that instant
+    double restoredTime = checkpointRestorePath.empty() ? 0.0 : checkpoint.time;
+    if (!checkpointSavePath.empty()) {
+        saveEvent = Simulator::Schedule(Seconds(std::max(0.0, checkpointAt - restoredTime)), &SaveCheckpoint);
+    }
+    if (checkpointRestorePath.empty()) {
+        LogPeriodicEnergyLevels(); // Start logging energy levels periodically
+        ScheduleClusterFormation();
+    } else {
+        engine.RestoreCheckpoint(checkpoint);
+        timeOffset += checkpoint.time;
+        runSummary.firstNodeDeathTime = checkpoint.firstDeathTime;
+        lifetime.Resume(std::count(nodeState.energy.begin(), nodeState.energy.end(), 0.0), checkpoint.firstDeathTime);
+        ResumeSchedule(checkpoint.time, checkpoint.round > 0);
+    }
+
+    stopEvent = Simulator::Stop(Seconds(config.duration - restoredTime));
+    leach::Profiler::Get().RunSimulator();
+    engine.SyncEnergy();
+    if (leach::GetRankCount() == 1) {
+        lifetime.SampleEnergy(nodeState.energy);
+    }
 
-    InitializeNodeEnergyLevels(sensorNodes);
-    LogPeriodicEnergyLevels(); // Start logging energy levels periodically
+    // The field's first death is the earliest over all ranks
+    double firstDeath = runSummary.firstNodeDeathTime < 0.0 ? std::numeric_limits<double>::infinity()
+                                                            : runSummary.firstNodeDeathTime;
+    firstDeath = leach::AllReduceMin(firstDeath);
+    runSummary.firstNodeDeathTime = std::isinf(firstDeath) ? -1.0 : firstDeath;
 
-    ScheduleClusterFormation(sensorNodes);
+    return runSummary;
+}
 
-    Simulator::Stop(Seconds(600.0));
-    Simulator::Run();
+// One complete simulation; replications call it once per forked worker
+leach::RunSummary RunSimulation(uint64_t run) {
+    BuildNetwork();
+    leach::RunSummary summary = RunProtocol(run);
     Simulator::Destroy();
+    return summary;
+}
+
+// Every sweep point on one network, built for the first point and reset in
+// between; one table row per point
+void RunSweep(const leach::ParameterSweep& sweep, uint64_t run, std::ostream& out, bool header) {
+    leach::SimulationConfig baseConfig = config;
+    sweep.Apply(0, config);
+    BuildNetwork();
+
+    if (header) {
+        out << "point";
+        for (const std::string& name : sweep.GetNames()) {
+            out << "\t" << name;
+        }
+        out << "\trun\tfirstNodeDeath\thalfNodeDeath\tlastNodeDeath\tmeanClusterHeads\tfinalAverageEnergy"
+               "\tenergyVariance" << std::endl;
+    }
+
+    for (uint32_t point = 0; point < sweep.GetPointCount(); ++point) {
+        config = baseConfig; // Unswept knobs keep their command-line values
+        sweep.Apply(point, config);
+        CancelPeriodicEvents();
+        engine.ResetProtocolState();
+        leach::RunSummary summary = RunProtocol(run);
+
+        out << point;
+        for (const std::string& value : sweep.GetPoint(point)) {
+            out << "\t" << value;
+        }
+        out << "\t" << run << "\t" << summary.firstNodeDeathTime << "\t" << lifetime.GetHalfDeath() << "\t"
+            << lifetime.GetLastDeath() << "\t" << lifetime.GetMeanHeads() << "\t" << engine.GlobalAverageEnergy()
+            << "\t" << lifetime.GetEnergyVariance() << std::endl;
+    }
+    CancelPeriodicEvents();
+    Simulator::Destroy();
+}
+
+int main(int argc, char *argv[]) {
+    bool benchmarkFormation = false;
+    uint32_t benchmarkNodes = 10000;
+    uint32_t benchmarkRepetitions = 10;
+    uint32_t replications = 1;
+    uint32_t jobs = 0;
+    uint32_t seed = 1;
+    uint64_t run = 1;
+    std::string energyTracePath;
+    std::string energyTraceText;
+    bool profile = false;
+    std::string profileJson;
+    std::string eventLogPath;
+    std::string eventLogText;
+    uint32_t eventRing = 0;
+    bool distributed = false;
+    std::string sweepSpec;
+    std::string sweepOutput;
+
+    CommandLine cmd;
+    cmd.AddValue("benchmarkFormation", "Compare indexed and brute-force FormClusters, then exit", benchmarkFormation);
+    cmd.AddValue("benchmarkNodes", "Sensors in the formation benchmark, at the configured density (0 = --nodes)", benchmarkNodes);
+    cmd.AddValue("benchmarkRepetitions", "Formation passes timed per method", benchmarkRepetitions);
+    cmd.AddValue("replications", "Number of independent runs; more than one runs them across a process pool", replications);
+    cmd.AddValue("jobs", "Worker processes for replications (0 = one per core)", jobs);
+    cmd.AddValue("seed", "RNG seed shared by all runs", seed);
+    cmd.AddValue("run", "RNG run number; replications use run, run + 1, ...", run);
+    cmd.AddValue("energyTrace", "Binary trace of every node's energy at each periodic report (single runs only)", energyTracePath);
+    cmd.AddValue("energyTraceText", "Text export of the energy trace written at exit (empty to skip)", energyTraceText);
+    cmd.AddValue("profile", "Report wall time per phase and protocol event counts at exit (single runs only)", profile);
+    cmd.AddValue("profileJson", "Also write the profile as JSON to this file", profileJson);
+    cmd.AddValue("eventLog", "Binary log of protocol events, formatted only on export (empty to log through LeachEvents)", eventLogPath);
+    cmd.AddValue("eventLogText", "Text export of the event log written at exit (empty to skip)", eventLogText);
+    cmd.AddValue("eventRing", "Without --eventLog, keep the last N protocol events in memory and print them at exit (0 to log through LeachEvents)", eventRing);
+    cmd.AddValue("sweep", "Run every point of name=v1,v2;name=... on one network built once, e.g. clusterHeadProbability=0.05,0.1", sweepSpec);
+    cmd.AddValue("sweepOutput", "Tab-separated sweep table, one row per point (empty for stdout)", sweepOutput);
+    cmd.AddValue("checkpointSave", "Write the protocol state to this file at --checkpointAt (empty to skip)", checkpointSavePath);
+    cmd.AddValue("checkpointAt", "Simulated second of the checkpoint", checkpointAt);
+    cmd.AddValue("checkpointRestore", "Resume from a checkpoint of the same --seed/--run instead of the warm-up (manual energy model)", checkpointRestorePath);
+    cmd.AddValue("distributed", "Split the field between MPI ranks (run under mpirun; needs --abstractRadio)", distributed);
+    config.AddValues(cmd);
+    cmd.Parse(argc, argv);
+    RngSeedManager::SetSeed(seed);
+
+    if (distributed) {
+        if (benchmarkFormation || replications > 1) {
+            NS_FATAL_ERROR("--distributed runs a single replication; drop --benchmarkFormation and --replications");
+        }
+        if (!checkpointSavePath.empty() || !checkpointRestorePath.empty()) {
+            NS_FATAL_ERROR("Checkpoints hold a whole field; they cannot be combined with --distributed");
+        }
+        if (config.stopDeadFraction > 0.0) {
+            NS_FATAL_ERROR("Ranks see only their own deaths; --stopDeadFraction cannot be combined with --distributed");
+        }
+        if (!leach::EnableDistributed(&argc, &argv)) {
+            NS_FATAL_ERROR("--distributed needs ns-3 built with MPI (NS3_MPI)");
+        }
+        if (!energyTracePath.empty() && leach::GetRankCount() > 1) {
+            energyTracePath += "." + std::to_string(leach::GetRank()); // One trace per rank
+        }
+    }
+
+    if (!sweepSpec.empty()) {
+        if (replications > 1 || !checkpointSavePath.empty()) {
+            NS_FATAL_ERROR("--sweep runs one replication per point and cannot write checkpoints");
+        }
+        if (config.mobility != "static") {
+            NS_FATAL_ERROR("Sweep points share one network, so mobile sensors cannot be reset; use --mobility=static");
+        }
+        leach::ParameterSweep sweep;
+        sweep.SetSpec(sweepSpec);
+        std::ofstream table;
+        bool header = true;
+        if (!sweepOutput.empty()) {
+            std::ifstream existing(sweepOutput);
+            header = !existing.is_open() || existing.peek() == std::ifstream::traits_type::eof();
+            table.open(sweepOutput, std::ios::app); // Appended, so several sweeps can share a table
+            if (!table.is_open()) {
+                NS_FATAL_ERROR("Cannot open sweep table " << sweepOutput);
+            }
+        }
+        RngSeedManager::SetRun(run);
+        RunSweep(sweep, run, sweepOutput.empty() ? std::cout : table, header);
+        leach::DisableDistributed();
+        return 0;
+    }
+
+    if (benchmarkFormation) {
+        RunFormationBenchmark(benchmarkNodes, benchmarkRepetitions);
+        Simulator::Destroy();
+        return 0;
+    }
+
+    if (replications > 1) {
+        // Per-run logging from many workers would interleave, so only the merged summary is printed
+        leach::ReplicationRunner runner(replications, jobs, run);
+        std::vector<leach::RunSummary> runs = runner.Run(&RunSimulation);
+        leach::ReplicationRunner::Print(std::cout, runs, leach::ReplicationRunner::Merge(runs));
+        return 0;
+    }
+
+    LogComponentEnable("LeachDmsNetworkSimulation", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEngine", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEvents", LOG_LEVEL_INFO);
+    // Formatting every event through LeachEvents is the slow path; --eventLog or --eventRing skip it
+    if (!eventLogPath.empty() && !leach::EventRecorder::Get().Open(eventLogPath)) {
+        NS_FATAL_ERROR("Cannot open event log " << eventLogPath);
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Enable(eventRing);
+    }
+    if (!energyTracePath.empty() && !energyTrace.Open(energyTracePath)) {
+        NS_FATAL_ERROR("Cannot open energy trace " << energyTracePath);
+    }
+    if (profile || !profileJson.empty()) {
+        leach::Profiler::Get().Enable();
+    }
+    RngSeedManager::SetRun(run);
+    RunSimulation(run);
+    lifetime.Print(std::cout);
+    leach::Profiler::Get().Finish(profileJson);
+    energyTrace.Close();
+    int status = 0; // The run is complete; a failed export is reported without cutting the other one short
+    if (!energyTracePath.empty() && !energyTraceText.empty() &&
+        !leach::EnergyTraceWriter::ExportText(energyTracePath, energyTraceText)) {
+        NS_LOG_ERROR("Cannot export energy trace " << energyTracePath << " to " << energyTraceText);
+        status = 1;
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Dump(std::clog);
+    }
+    leach::EventRecorder::Get().Close();
+    if (!eventLogPath.empty() && !eventLogText.empty() &&
+        !leach::EventRecorder::ExportText(eventLogPath, eventLogText)) {
+        NS_LOG_ERROR("Cannot export event log " << eventLogPath << " to " << eventLogText);
+        status = 1;
+    }
+    leach::DisableDistributed();
 
-    return 0;
+    return status;
 }
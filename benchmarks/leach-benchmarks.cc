@@ -0,0 +1,279 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "profiler.h"
+#include "protocol-engine.h"
+#include "simulation-config.h"
+#include "tick-group.h"
+
+using namespace ns3;
+
+// Benchmarks of the protocol engine, one tab-separated row per kernel or run
+// and node count. Micro benchmarks time the per-round kernels on the abstract
+// radio; ApplyLinkTxPower needs Wi-Fi devices and is limited to --wifiMaxNodes.
+// Macro benchmarks run the full round / frame schedule and report events/s,
+// sim-s/wall-s and the process's peak RSS, which only grows, so sizes run in
+// increasing order. The threads mode is a check rather than a benchmark: it
+// forms the same network serially and on --threads workers and exits non-zero
+// unless heads and members match.
+//
+//   leach-benchmarks --mode=micro --sizes=100,1000,10000,100000
+//   leach-benchmarks --mode=threads --sizes=5000 --threads=4
+
+NS_LOG_COMPONENT_DEFINE("LeachBenchmarks");
+
+leach::SimulationConfig config; // Field and policies of the benchmarked network
+leach::ProtocolEngine engine(config); // The kernels under test
+leach::TickGroup frameTicks(leach::EVENT_CLUSTER_FRAME); // Macro runs: serving heads, framed once per frame
+double checksum = 0.0; // Kernel results; printed so the timed loops are not optimized away
+
+std::vector<uint32_t> ParseSizes(const std::string& sizes) {
+    std::vector<uint32_t> parsed;
+    std::stringstream stream(sizes);
+    std::string size;
+    while (std::getline(stream, size, ',')) {
+        parsed.push_back(static_cast<uint32_t>(std::stoul(size)));
+    }
+    return parsed;
+}
+
+// The same node density at every size: 100 nodes per 100 m x 100 m, sink at the center
+void ConfigureField(uint32_t numNodes, bool abstractRadio) {
+    config.numNodes = numNodes;
+    config.topology = "uniform";
+    config.fieldSize = 100.0 * std::sqrt(numNodes / 100.0);
+    config.sinkX = config.fieldSize / 2.0;
+    config.sinkY = config.fieldSize / 2.0;
+    config.abstractRadio = abstractRadio;
+    config.energyModel = "manual";
+}
+
+void BuildNetwork() {
+    engine.CreateNodes();
+    engine.SetupNodes();
+    engine.SetupEnergyModel();
+    engine.SetMobility();
+}
+
+// Mean wall seconds per call of f over repetitions calls
+template <class F>
+double TimePerCall(uint32_t repetitions, F f) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    for (uint32_t r = 0; r < repetitions; ++r) {
+        f();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count() / repetitions;
+}
+
+// Mean wall seconds per call of f, each after an untimed call of setup
+template <class Setup, class F>
+double TimePerCall(uint32_t repetitions, Setup setup, F f) {
+    using Clock = std::chrono::steady_clock;
+    Clock::duration total = Clock::duration::zero();
+    for (uint32_t r = 0; r < repetitions; ++r) {
+        setup();
+        Clock::time_point start = Clock::now();
+        f();
+        total += Clock::now() - start;
+    }
+    return std::chrono::duration<double>(total).count() / repetitions;
+}
+
+void PrintKernel(const char* kernel, uint32_t numNodes, double seconds) {
+    std::cout << kernel << "\t" << numNodes << "\t" << seconds * 1e6 << "\t" << seconds * 1e9 / numNodes
+              << std::endl;
+}
+
+void ClearMembers() {
+    for (leach::Cluster& cluster : engine.GetClusters()) {
+        cluster.members.clear();
+    }
+}
+
+void RunMicro(uint32_t numNodes, uint32_t repetitions, uint32_t wifiMaxNodes) {
+    ConfigureField(numNodes, true);
+    BuildNetwork();
+    leach::NodeStateTable& state = engine.GetState();
+
+    // Every repetition elects the first round of a fresh network; back to back they
+    // would walk through the epoch, where ever fewer nodes are eligible
+    PrintKernel("ElectClusterHeads", numNodes, TimePerCall(repetitions, []() { engine.ResetProtocolState(); },
+                                                           []() { engine.ElectClusterHeads(); }));
+
+    // Formation against one head set, members cleared between passes
+    engine.ResetProtocolState();
+    engine.ElectClusterHeads();
+    PrintKernel("FormClusters", numNodes,
+                TimePerCall(repetitions, &ClearMembers, []() { engine.FormClusters(); }));
+
+    PrintKernel("TransmissionPower", numNodes, TimePerCall(repetitions, [&state, numNodes]() {
+        for (uint32_t i = 0; i < numNodes; ++i) {
+            checksum += engine.TransmissionPower(state.linkDistance[i]);
+        }
+    }));
+
+    PrintKernel("LinkTransmissionPower", numNodes, TimePerCall(repetitions, []() {
+        for (const leach::Cluster& cluster : engine.GetClusters()) {
+            for (uint32_t memberId : cluster.members) {
+                checksum += engine.LinkTransmissionPower(memberId, cluster.clusterHead);
+            }
+        }
+    }));
+
+    PrintKernel("ChargeClusterFrame", numNodes, TimePerCall(repetitions, []() {
+        for (const leach::Cluster& cluster : engine.GetClusters()) {
+            engine.ChargeClusterFrame(cluster.clusterHead, 1, 1e-9, [](uint32_t, double txPower) { checksum += txPower; },
+                                      [](uint32_t, double) {});
+        }
+    }));
+
+    PrintKernel("UpdateEnergy", numNodes, TimePerCall(repetitions, [numNodes]() {
+        for (uint32_t i = 0; i < numNodes; ++i) {
+            checksum += engine.UpdateEnergy(i, 1e-9);
+        }
+    }));
+    Simulator::Destroy();
+
+    // Setting the PHY power needs real devices
+    if (numNodes > wifiMaxNodes) {
+        return;
+    }
+    ConfigureField(numNodes, false);
+    BuildNetwork();
+    engine.ElectClusterHeads();
+    engine.FormClusters();
+    engine.SetupUplinks();
+    PrintKernel("ApplyLinkTxPower", numNodes, TimePerCall(repetitions, [numNodes]() {
+        for (uint32_t i = 0; i < numNodes; ++i) {
+            engine.ApplyLinkTxPower(i);
+        }
+    }));
+    Simulator::Destroy();
+}
+
+void ChargeHop(uint32_t nodeId, double energy) {
+    engine.UpdateEnergy(nodeId, energy);
+}
+
+// One frame of a cluster: every member reports, the head forwards one uplink
+void MacroFrame(uint32_t headId) {
+    leach::NodeStateTable& state = engine.GetState();
+    if (!state.IsClusterHead(headId)) {
+        return;
+    }
+    engine.ChargeClusterFrame(headId, config.payloadBytes, 0.1, [](uint32_t, double) {}, [](uint32_t, double) {});
+    engine.ForwardUplink(headId, config.payloadBytes, config.uplinkCost, &ChargeHop);
+}
+
+void MacroRound() {
+    engine.ElectClusterHeads();
+    engine.FormClusters();
+    engine.SetupUplinks();
+    frameTicks.Clear();
+    for (const leach::Cluster& cluster : engine.GetClusters()) {
+        frameTicks.Add(cluster.clusterHead);
+    }
+    frameTicks.Start();
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_SCHEDULE_CLUSTER_FORMATION, &MacroRound));
+}
+
+void RunMacro(uint32_t numNodes, double duration) {
+    ConfigureField(numNodes, true);
+    BuildNetwork();
+    frameTicks.Resize(numNodes);
+    frameTicks.SetPeriod(config.frameLength);
+    frameTicks.SetCallback(MakeCallback(&MacroFrame));
+    MacroRound();
+
+    Simulator::Stop(Seconds(duration));
+    leach::Profiler& profiler = leach::Profiler::Get();
+    profiler.RunSimulator();
+    double wall = profiler.GetRunWallSeconds();
+    std::cout << "FullRun\t" << numNodes << "\t" << wall << "\t"
+              << (wall > 0.0 ? profiler.GetTotalEvents() / wall : 0.0) << "\t"
+              << (wall > 0.0 ? profiler.GetSimulatedSeconds() / wall : 0.0) << "\t"
+              << leach::Profiler::GetPeakRssBytes() / (1024.0 * 1024.0) << std::endl;
+    frameTicks.Stop();
+    Simulator::Destroy();
+}
+
+// Elect and form one round against a fresh copy of the network's state
+std::vector<leach::Cluster> FormRound(uint32_t threads) {
+    config.threads = threads;
+    engine.ResetProtocolState(); // Same streams, so the same draws
+    engine.ElectClusterHeads();
+    engine.FormClusters();
+    return engine.GetClusters();
+}
+
+// Cluster heads and member lists of a serial and a threaded round must match
+bool RunThreadsCheck(uint32_t numNodes, uint32_t threads) {
+    ConfigureField(numNodes, true);
+    BuildNetwork();
+    std::vector<leach::Cluster> serial = FormRound(1);
+    std::vector<leach::Cluster> parallel = FormRound(threads);
+    Simulator::Destroy();
+
+    bool match = serial.size() == parallel.size();
+    for (size_t c = 0; match && c < serial.size(); ++c) {
+        match = serial[c].clusterHead == parallel[c].clusterHead && serial[c].members == parallel[c].members;
+    }
+    std::cout << "FormClusters\t" << numNodes << "\t" << threads << "\t" << serial.size() << "\t"
+              << (match ? "match" : "MISMATCH") << std::endl;
+    return match;
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = "all";
+    std::string sizes = "100,1000,10000,100000";
+    uint32_t repetitions = 20;
+    uint32_t wifiMaxNodes = 1000;
+    double macroDuration = 200.0;
+
+    CommandLine cmd;
+    cmd.AddValue("mode", "micro, macro, all or threads", mode);
+    cmd.AddValue("sizes", "Comma-separated node counts, in increasing order", sizes);
+    cmd.AddValue("repetitions", "Timed calls per micro benchmark", repetitions);
+    cmd.AddValue("wifiMaxNodes", "Largest network ApplyLinkTxPower installs Wi-Fi on", wifiMaxNodes);
+    cmd.AddValue("macroDuration", "Simulated seconds per full run", macroDuration);
+    config.AddValues(cmd);
+    cmd.Parse(argc, argv);
+    if (mode != "micro" && mode != "macro" && mode != "all" && mode != "threads") {
+        NS_FATAL_ERROR("Unknown benchmark mode '" << mode << "'; expected micro, macro, all or threads");
+    }
+    std::vector<uint32_t> nodeCounts = ParseSizes(sizes);
+
+    if (mode == "threads") {
+        uint32_t threads = config.threads > 1 ? config.threads : 4;
+        bool match = true;
+        std::cout << "kernel\tnodes\tthreads\tclusters\tresult" << std::endl;
+        for (uint32_t numNodes : nodeCounts) {
+            match = RunThreadsCheck(numNodes, threads) && match;
+        }
+        return match ? 0 : 1;
+    }
+
+    if (mode != "macro") {
+        std::cout << "kernel\tnodes\tus/call\tns/node" << std::endl;
+        for (uint32_t numNodes : nodeCounts) {
+            RunMicro(numNodes, repetitions, wifiMaxNodes);
+        }
+    }
+    if (mode != "micro") {
+        std::cout << "run\tnodes\twallSeconds\tevents/s\tsim-s/wall-s\tpeakRssMiB" << std::endl;
+        for (uint32_t numNodes : nodeCounts) {
+            RunMacro(numNodes, macroDuration);
+        }
+    }
+    std::clog << "checksum " << checksum << std::endl;
+
+    return 0;
+}
@@ -5,156 +5,158 @@
 #include "ns3/internet-module.h"
 #include "ns3/energy-module.h"
 #include <fstream>
+#include <iostream>
+
+#include "energy-threshold-monitor.h"
+#include "energy-trace-writer.h"
+#include "event-recorder.h"
+#include "lifetime-statistics.h"
+#include "profiler.h"
+#include "protocol-engine.h"
+#include "simulation-config.h"
 
 using namespace ns3;
 using namespace ns3::energy;
 
 NS_LOG_COMPONENT_DEFINE("LeachDmsNetworkSimulation");
 
-// Function to set transmission power based on DMS
-double SetTransmissionPower(double distance, bool isHighPriority) {
-    double basePower = 1.0;  // Base transmission power level
-    if (isHighPriority) {
-        return basePower * 1.5;  // Higher power for urgent data
-    } else if (distance > 50.0) {
-        return basePower * 1.2;  // Moderate power for longer distances
-    } else {
-        return basePower * 0.8;  // Low power for short distances
-    }
-}
+leach::SimulationConfig config; // Node count, field, p, duration, energy and policies from the command line
+leach::ProtocolEngine engine(config); // Node setup, energy sources and transmission power
 
-// Function to log energy level with a check for significant drop (5%)
-void LogEnergyLevel(Ptr<Node> node, Ptr<BasicEnergySource> energySource, double *lastReportedEnergy) {
-    double currentEnergy = energySource->GetRemainingEnergy();
-    double thresholdDrop = *lastReportedEnergy * 0.05;
-
-    // Report only if there is a significant drop (5%)
-    if (*lastReportedEnergy - currentEnergy >= thresholdDrop) {
-        NS_LOG_INFO("Time: " << Simulator::Now().GetSeconds() 
-                              << "s, Node " << node->GetId() 
-                              << " Energy: " << currentEnergy << "J");
-        
-        // Log energy to a file
-        std::ofstream energyLog("energy_log.txt", std::ios::app);
-        energyLog << "Time: " << Simulator::Now().GetSeconds()
-                  << "s, Node " << node->GetId() 
-                  << " Energy: " << currentEnergy << "J" << std::endl;
-        energyLog.close();
-
-        // Update the last reported energy level
-        *lastReportedEnergy = currentEnergy;
-    }
+leach::EnergyTraceWriter energyTrace; // Buffered binary (time, node, energy) samples
+leach::EnergyThresholdMonitor energyMonitor(engine.GetState(), 0.05, 0.0); // Report 5% drops and depletion at 0 J
+leach::LifetimeStatistics lifetime; // Node deaths and residual energy, printed at exit
 
-    // Schedule the next energy log check
-    Simulator::Schedule(Seconds(1.0), &LogEnergyLevel, node, energySource, lastReportedEnergy);
-}
+// Log energy level after a significant drop (5%); called by the energy monitor
+void LogEnergyLevel(uint32_t nodeId, double currentEnergy) {
+    leach::EventRecorder::Get().Record(leach::RECORD_LOW_ENERGY, nodeId, leach::EventRecorder::kNone, currentEnergy);
 
-// Function to check if a node's energy is depleted
-void CheckNodeEnergyDepletion(Ptr<Node> node, Ptr<BasicEnergySource> energySource) {
-    if (energySource->GetRemainingEnergy() <= 0) {
-        NS_LOG_INFO("Node " << node->GetId() << " has depleted its energy at time: " 
-                            << Simulator::Now().GetSeconds() << "s");
-    } else {
-        // Schedule the next check
-        Simulator::Schedule(Seconds(1.0), &CheckNodeEnergyDepletion, node, energySource);
-    }
+    // Log energy to the trace file
+    energyTrace.Record(Simulator::Now().GetSeconds(), nodeId, currentEnergy);
 }
 
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices) {
-    // Install WiFi and IP on nodes
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
-
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper wifiPhy;
-    wifiPhy.SetChannel(wifiChannel.Create());
-
-    WifiMacHelper wifiMac;
-    wifiMac.SetType("ns3::AdhocWifiMac");  // Ad-hoc mode for direct communication
-
-    devices = wifi.Install(wifiPhy, wifiMac, nodes);
-
-    InternetStackHelper stack;
-    stack.Install(nodes);
-
-    Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    address.Assign(devices);
+// Report a node whose energy is depleted; called once per node by the energy monitor
+void LogNodeEnergyDepletion(uint32_t nodeId, double) {
+    NS_LOG_INFO("Node " << nodeId << " has depleted its energy at time: " 
+                        << Simulator::Now().GetSeconds() << "s");
+    lifetime.OnNodeDeath(Simulator::Now().GetSeconds());
 }
 
-void SetupEnergyModel(NodeContainer nodes, NetDeviceContainer devices) {
-    // Configure energy sources and consumption models
-    BasicEnergySourceHelper energySourceHelper;
-    energySourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(100.0));
-
-    EnergySourceContainer energySources = energySourceHelper.Install(nodes);
-
-    WifiRadioEnergyModelHelper radioEnergyHelper;
-    radioEnergyHelper.Set("TxCurrentA", DoubleValue(0.017));  // Transmit current
-    radioEnergyHelper.Set("RxCurrentA", DoubleValue(0.019));  // Receive current
-    radioEnergyHelper.Install(devices, energySources);
-
-    // Schedule energy logging and depletion checks for each node
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        Ptr<BasicEnergySource> energySource = DynamicCast<BasicEnergySource>(energySources.Get(node->GetId()));
-        
-        // Initialize the last reported energy level with the initial energy level
-        double initialEnergy = energySource->GetInitialEnergy();
-        Simulator::Schedule(Seconds(1.0), &LogEnergyLevel, node, energySource, new double(initialEnergy));
-        
-        // Check energy depletion
-        Simulator::Schedule(Seconds(1.0), &CheckNodeEnergyDepletion, node, energySource);
-    }
-}
+// Energy logging and depletion reports are driven by the energy sources' own updates
+void SubscribeEnergyMonitor() {
+    EnergySourceContainer energySources = engine.GetEnergySources();
+    energyMonitor.SetStepCallback(MakeCallback(&LogEnergyLevel));
+    energyMonitor.SetDepletionCallback(MakeCallback(&LogNodeEnergyDepletion));
 
-void SetMobility(NodeContainer nodes) {
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
-        positionAlloc->Add(Vector(10.0 * i, 10.0 * i, 0.0));  // Arrange in a grid
+    for (uint32_t i = 0; i < energySources.GetN(); ++i) {
+        Ptr<BasicEnergySource> energySource = DynamicCast<BasicEnergySource>(energySources.Get(i));
+        energyMonitor.Subscribe(i, energySource);
     }
-    mobility.SetPositionAllocator(positionAlloc);
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(nodes);
 }
 
-void SimulateLeachProtocol(NodeContainer nodes) {
+void SimulateLeachProtocol(const leach::NodeRegistry& nodes) {
     // Placeholder function to simulate LEACH behavior
     for (uint32_t i = 0; i < nodes.GetN(); ++i) {
-        Ptr<Node> node = nodes.Get(i);
         double distanceToBaseStation = 50.0 + 10.0 * i;  // Example distance
         bool isHighPriority = (i % 5 == 0);  // Assign priority based on node index
 
-        double txPower = SetTransmissionPower(distanceToBaseStation, isHighPriority);
-        NS_LOG_INFO("Node " << node->GetId() << ": Transmission power set to " << txPower);
+        double txPower = engine.TransmissionPower(distanceToBaseStation, isHighPriority);
+        NS_LOG_INFO("Node " << i << ": Transmission power set to " << txPower);
     }
 }
 
 int main(int argc, char *argv[]) {
+    std::string energyTracePath = "energy_log.bin";
+    std::string energyTraceText = "energy_log.txt";
+    bool profile = false;
+    std::string profileJson;
+    std::string eventLogPath;
+    std::string eventLogText;
+    uint32_t eventRing = 0;
+
+    CommandLine cmd;
+    cmd.AddValue("energyTrace", "Binary energy trace file (empty to disable)", energyTracePath);
+    cmd.AddValue("energyTraceText", "Text export of the energy trace written at exit (empty to skip)", energyTraceText);
+    cmd.AddValue("profile", "Report wall time per phase and event counts at exit", profile);
+    cmd.AddValue("profileJson", "Also write the profile as JSON to this file", profileJson);
+    cmd.AddValue("eventLog", "Binary log of protocol events, formatted only on export (empty to log through LeachEvents)", eventLogPath);
+    cmd.AddValue("eventLogText", "Text export of the event log written at exit (empty to skip)", eventLogText);
+    cmd.AddValue("eventRing", "Without --eventLog, keep the last N protocol events in memory and print them at exit (0 to log through LeachEvents)", eventRing);
+    config.energyModel = "basic"; // BasicEnergySource drained by the Wi-Fi radio model
+    config.powerPolicy = "priority"; // Urgent data at full power
+    config.AddValues(cmd);
+    cmd.Parse(argc, argv);
+    if (config.mobility != "static") {
+        NS_FATAL_ERROR("This variant never re-checks moving members; --mobility needs customexample3 or WSN_Leach_DSM");
+    }
+    if (profile || !profileJson.empty()) {
+        leach::Profiler::Get().Enable();
+    }
+
     LogComponentEnable("LeachDmsNetworkSimulation", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEngine", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEvents", LOG_LEVEL_INFO);
+    // Formatting every event through LeachEvents is the slow path; --eventLog or --eventRing skip it
+    if (!eventLogPath.empty() && !leach::EventRecorder::Get().Open(eventLogPath)) {
+        NS_FATAL_ERROR("Cannot open event log " << eventLogPath);
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Enable(eventRing);
+    }
+    if (!energyTracePath.empty() && !energyTrace.Open(energyTracePath)) {
+        NS_FATAL_ERROR("Cannot open energy trace " << energyTracePath);
+    }
 
-    // Set the simulation end time (e.g., 600 seconds)
-    Simulator::Stop(Seconds(600.0));
+    // Set the simulation end time; --stopDeadFraction may end it earlier
+    Simulator::Stop(Seconds(config.duration));
+    lifetime.Reset(config.numNodes, config.initialEnergy, config.stopDeadFraction);
 
     // Step 1: Create and configure nodes
-    NodeContainer sensorNodes;
-    sensorNodes.Create(10);
+    engine.CreateNodes();
     NS_LOG_INFO("Creating sensor nodes...");
 
-    NetDeviceContainer devices;
-    SetupNodes(sensorNodes, devices);      // Configure WiFi and IP
-    SetupEnergyModel(sensorNodes, devices); // Add energy models
-    SetMobility(sensorNodes);               // Set mobility
+    {
+        leach::Profiler::ScopedPhase phase("SetupNodes");
+        engine.SetupNodes();        // Configure WiFi and IP
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetupEnergyModel");
+        engine.SetupEnergyModel();  // Add energy models
+        SubscribeEnergyMonitor();
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetMobility");
+        engine.SetMobility();       // Set mobility
+    }
 
     // Step 2: Simulate LEACH with DMS
     NS_LOG_INFO("Simulating LEACH protocol with DMS...");
-    SimulateLeachProtocol(sensorNodes);
+    SimulateLeachProtocol(engine.GetRegistry());
 
     // Step 3: Run simulation
-    Simulator::Run();
+    leach::Profiler::Get().RunSimulator();
+    engine.SyncEnergy();
+    lifetime.SampleEnergy(engine.GetState().energy);
     Simulator::Destroy();
+    lifetime.Print(std::cout);
+    leach::Profiler::Get().Finish(profileJson);
+    energyTrace.Close();
+    int status = 0; // The run is complete; a failed export is reported without cutting the other one short
+    if (!energyTracePath.empty() && !energyTraceText.empty() &&
+        !leach::EnergyTraceWriter::ExportText(energyTracePath, energyTraceText)) {
+        NS_LOG_ERROR("Cannot export energy trace " << energyTracePath << " to " << energyTraceText);
+        status = 1;
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Dump(std::clog);
+    }
+    leach::EventRecorder::Get().Close();
+    if (!eventLogPath.empty() && !eventLogText.empty() &&
+        !leach::EventRecorder::ExportText(eventLogPath, eventLogText)) {
+        NS_LOG_ERROR("Cannot export event log " << eventLogPath << " to " << eventLogText);
+        status = 1;
+    }
     NS_LOG_INFO("Simulation complete.");
 
-    return 0;
+    return status;
 }
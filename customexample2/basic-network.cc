@@ -4,209 +4,336 @@
 #include "ns3/wifi-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/energy-module.h"
-#include <map>
+#include <iostream>
 #include <vector>
-#include <fstream>
+
+#include "data-aggregator.h"
+#include "energy-threshold-monitor.h"
+#include "energy-trace-writer.h"
+#include "event-recorder.h"
+#include "profiler.h"
+#include "protocol-engine.h"
+#include "simulation-config.h"
+#include "tdma-schedule.h"
 
 using namespace ns3;
 using namespace ns3::energy;
 
 NS_LOG_COMPONENT_DEFINE("LeachDmsNetworkSimulation");
 
-struct Cluster {
-    Ptr<Node> clusterHead;
-    std::vector<Ptr<Node>> members;
-};
-
-std::map<uint32_t, Cluster> clusters;
-double clusterHeadProbability = 0.2;
-std::map<uint32_t, double> lastReportedEnergy;
+leach::SimulationConfig config; // Node count, field, p, duration, energy and policies from the command line
+leach::ProtocolEngine engine(config); // Node setup, energy sources, election and formation
+leach::NodeStateTable& nodeState = engine.GetState(); // Per-node reported energy, role and cluster membership
+std::vector<leach::Cluster>& clusters = engine.GetClusters(); // Clusters of the current round, in election order
+leach::RoundScheduler& roundScheduler = engine.GetRoundScheduler(); // Owns the TDMA slot events of the current round
+leach::DataAggregator aggregator; // Member readings buffered at each head until the frame's uplink
+const uint16_t aggregateProtocol = 0x88B5; // Local experimental EtherType carried by fused uplinks
+const uint16_t readingProtocol = 0x88B6; // Member readings to their head, kept apart from uplinks a relay head overhears
+leach::EnergyTraceWriter energyTrace; // Buffered binary (time, node, energy) samples
+leach::TdmaSchedule tdma; // Slot of every node in its cluster's frame
+leach::EnergyThresholdMonitor energyMonitor(engine.GetState(), 2.0, 0.0); // Depletion at 0 J only; LogEnergyLevels samples the drops
+std::vector<uint32_t> deadNodes; // Emptied this instant; they leave their clusters once the current event is done
 
 // Declare functions at the beginning
-void ClearClusters();
-void ElectClusterHeads(NodeContainer nodes, EnergySourceContainer energySources);
-void FormClusters(NodeContainer nodes);
-void SetupClusterCommunications(NodeContainer nodes, Ptr<Node> baseStation);
-void LogEnergyLevels(EnergySourceContainer energySources);
-void ScheduleClusterFormation(NodeContainer nodes, EnergySourceContainer energySources);
-void BatchIntraClusterCommunication(NodeContainer nodes);
-void BatchInterClusterCommunication(NodeContainer nodes, Ptr<Node> baseStation);
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices);
-EnergySourceContainer SetupEnergyModel(NodeContainer nodes, NetDeviceContainer devices);
-void SetMobility(NodeContainer nodes);
-
-// Clear previous clusters
-void ClearClusters() {
-    clusters.clear();
+void ElectClusterHeads();
+void LogEnergyLevels();
+void ScheduleClusterFormation();
+void SetupTdmaSchedule();
+void SetRadioSleep(uint32_t nodeId, bool sleep);
+void ChargeEnergy(uint32_t nodeId, double energyUsed);
+void ReportDepletion(uint32_t nodeId, double energy);
+void RetireDeadNodes();
+void BatchIntraClusterCommunication();
+void MemberSlot(uint32_t memberId, uint32_t headId, double slotLength);
+void DeliverReading(uint32_t headId);
+void ReceiveReading(uint32_t nodeId, Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                    const Address& from, const Address& to, NetDevice::PacketType packetType);
+void HeadUplink(uint32_t headId);
+void BatchInterClusterCommunication(uint32_t baseStationId);
+
+// Elect cluster heads; readings buffered for the previous round's heads are dropped
+void ElectClusterHeads() {
+    aggregator.Clear();
+    engine.ElectClusterHeads();
 }
 
-// Elect cluster heads
-void ElectClusterHeads(NodeContainer nodes, EnergySourceContainer energySources) {
-    ClearClusters();
-
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        Ptr<BasicEnergySource> energySource = DynamicCast<BasicEnergySource>(energySources.Get(node->GetId()));
-        
-        if ((double)rand() / RAND_MAX <= clusterHeadProbability && energySource->GetRemainingEnergy() > 10.0) {
-            Cluster newCluster;
-            newCluster.clusterHead = node;
-            clusters[node->GetId()] = newCluster;
-            NS_LOG_INFO("Node " << node->GetId() << " elected as cluster head with energy: " 
-                                << energySource->GetRemainingEnergy());
-        }
+// Heads lay out their TDMA frames once clusters are formed; members sleep until their slot
+void SetupTdmaSchedule() {
+    tdma.Build(nodeState, clusters.size());
+    for (uint32_t i = 0; i < nodeState.GetN(); i++) {
+        SetRadioSleep(i, nodeState.role[i] == leach::ROLE_MEMBER);
+    }
+    engine.SetupUplinks();
+    for (const leach::Cluster& cluster : clusters) {
+        NS_LOG_INFO("Cluster Head " << cluster.clusterHead << " scheduled " << cluster.members.size()
+                    << " member slots of " << tdma.GetSlotLength(nodeState.clusterIndex[cluster.clusterHead]) << " s");
     }
 }
 
-// Form clusters
-void FormClusters(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        
-        if (clusters.find(node->GetId()) == clusters.end()) {  // Only add non-cluster-head nodes
-            double minDistance = std::numeric_limits<double>::max();
-            Ptr<Node> closestClusterHead = nullptr;
-            
-            for (auto& entry : clusters) {
-                Ptr<Node> clusterHead = entry.second.clusterHead;
-                double distance = node->GetObject<MobilityModel>()->GetDistanceFrom(clusterHead->GetObject<MobilityModel>());
-                
-                if (distance < minDistance) {
-                    minDistance = distance;
-                    closestClusterHead = clusterHead;
-                }
-            }
-            
-            if (closestClusterHead) {
-                clusters[closestClusterHead->GetId()].members.push_back(node);
-                NS_LOG_INFO("Node " << node->GetId() << " joined cluster with head " << closestClusterHead->GetId());
-            }
-        }
+// Charge a node; under the manual model this is where its energy runs out,
+// under the basic model the monitor sees the source empty
+void ChargeEnergy(uint32_t nodeId, double energyUsed) {
+    if (engine.UpdateEnergy(nodeId, energyUsed) == 0.0 && nodeState.alive[nodeId]) {
+        energyMonitor.NotifyDepleted(nodeId);
     }
 }
 
-// Batch intra-cluster communication
-void BatchIntraClusterCommunication(NodeContainer nodes) {
-    for (auto& entry : clusters) {
-        Ptr<Node> clusterHead = entry.second.clusterHead;
-        uint32_t transmissionCount = 0;
-        
-        for (Ptr<Node> member : entry.second.members) {
-            transmissionCount++;
-        }
-        
-        if (transmissionCount > 0) {
-            NS_LOG_INFO("Cluster Head " << clusterHead->GetId() << " received " << transmissionCount 
-                         << " transmissions from its members.");
-        }
+// A depleted node can no longer be elected or join a cluster; it leaves its
+// current one right after this event, which may be walking that cluster
+void ReportDepletion(uint32_t nodeId, double) {
+    NS_LOG_INFO("Node " << nodeId << " has depleted its energy at time: " << Simulator::Now().GetSeconds() << "s");
+    leach::EventRecorder::Get().Record(leach::RECORD_NODE_FAILED, nodeId);
+    if (deadNodes.empty()) {
+        Simulator::ScheduleNow(leach::Profiled(leach::EVENT_CHECK_NODE_FAILURE, &RetireDeadNodes));
     }
-    Simulator::Schedule(Seconds(20.0), &BatchIntraClusterCommunication, nodes); // Schedule next report
+    deadNodes.push_back(nodeId);
 }
 
-// Batch inter-cluster communication
-void BatchInterClusterCommunication(NodeContainer nodes, Ptr<Node> baseStation) {
-    uint32_t clusterHeadTransmissionCount = clusters.size();
-    NS_LOG_INFO("Base Station received data from " << clusterHeadTransmissionCount << " cluster heads.");
-    Simulator::Schedule(Seconds(20.0), &BatchInterClusterCommunication, nodes, baseStation); // Schedule next report
+// Take dead nodes out of their clusters, as customexample3's failure check
+// does, and lay the frames out again for the clusters that are left
+void RetireDeadNodes() {
+    for (uint32_t nodeId : deadNodes) {
+        if (nodeState.IsClusterHead(nodeId)) {
+            uint32_t cluster = nodeState.clusterIndex[nodeId];
+            if (engine.PromoteBackupHead(nodeId)) {
+                SetRadioSleep(clusters[cluster].clusterHead, false); // The successor listens for the whole frame
+            } else {
+                engine.RepairCluster(nodeId);
+            }
+        } else if (nodeState.role[nodeId] == leach::ROLE_MEMBER) {
+            engine.RemoveMember(nodeId);
+        }
+    }
+    deadNodes.clear();
+    tdma.Build(nodeState, clusters.size());
 }
 
-// Schedule cluster formation and periodic reporting
-void ScheduleClusterFormation(NodeContainer nodes, EnergySourceContainer energySources) {
-    Simulator::Schedule(Seconds(20.0), &ElectClusterHeads, nodes, energySources);
-    Simulator::Schedule(Seconds(20.0), &FormClusters, nodes);
-    Simulator::Schedule(Seconds(50.0), &LogEnergyLevels, energySources); // Log energy levels every 50 seconds
-    Simulator::Schedule(Seconds(50.0), &ScheduleClusterFormation, nodes, energySources); // Schedule next formation
+// Put a node's PHY to sleep or wake it up; sleep requested mid-transmission waits for the end of it
+void SetRadioSleep(uint32_t nodeId, bool sleep) {
+    if (engine.IsAbstractRadio()) {
+        return; // No PHY to switch
+    }
+    Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice>(engine.GetDevice(nodeId))->GetPhy();
+    if (sleep && !phy->IsStateSleep()) {
+        phy->SetSleepMode();
+    } else if (!sleep && phy->IsStateSleep()) {
+        phy->ResumeFromSleep();
+    }
 }
 
-// Log energy levels only when there's a significant change
-void LogEnergyLevels(EnergySourceContainer energySources) {
-    for (uint32_t i = 0; i < energySources.GetN(); i++) {
-        Ptr<BasicEnergySource> energySource = DynamicCast<BasicEnergySource>(energySources.Get(i));
-        double currentEnergy = energySource->GetRemainingEnergy();
-
-        if (lastReportedEnergy.find(i) == lastReportedEnergy.end() || 
-            (lastReportedEnergy[i] - currentEnergy) >= (lastReportedEnergy[i] * 0.05)) {
-            NS_LOG_INFO("Node " << i << " energy level: " << currentEnergy << " J");
-            lastReportedEnergy[i] = currentEnergy;
+// Batch intra-cluster communication: at the start of every TDMA frame each
+// member gets its slot and the head's fused uplink is queued for the last one,
+// so transmissions inside a cluster never contend for the channel
+void BatchIntraClusterCommunication() {
+    for (const leach::Cluster& cluster : clusters) {
+        uint32_t headId = cluster.clusterHead;
+        uint32_t clusterIdx = nodeState.clusterIndex[headId];
+        double slotLength = tdma.GetSlotLength(clusterIdx);
+        for (uint32_t memberId : cluster.members) {
+            roundScheduler.Schedule(Seconds(tdma.GetSlotOffset(memberId, clusterIdx)),
+                                    leach::Profiled(leach::EVENT_TDMA_SLOT, &MemberSlot, memberId, headId, slotLength));
         }
+        roundScheduler.Schedule(Seconds(tdma.GetSlotOffset(headId, clusterIdx)),
+                                leach::Profiled(leach::EVENT_HEAD_UPLINK, &HeadUplink, headId));
     }
+    Simulator::Schedule(Seconds(tdma.GetFrameLength()), leach::Profiled(leach::EVENT_BATCH_INTRA_CLUSTER, &BatchIntraClusterCommunication)); // Schedule next frame
 }
 
-// Basic node setup
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices) {
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
-
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper wifiPhy;
-    wifiPhy.SetChannel(wifiChannel.Create());
-
-    WifiMacHelper wifiMac;
-    wifiMac.SetType("ns3::AdhocWifiMac");
-
-    devices = wifi.Install(wifiPhy, wifiMac, nodes);
-
-    InternetStackHelper stack;
-    stack.Install(nodes);
-
-    Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    address.Assign(devices);
+// A member wakes for its slot, sends its reading to the head at the power its
+// link needs and sleeps again at the end of the slot. In abstract-radio mode
+// the link table decides whether and when the reading arrives; on the full
+// stack the head takes it from its receive handler.
+void MemberSlot(uint32_t memberId, uint32_t headId, double slotLength) {
+    if (!nodeState.alive[memberId] || !nodeState.alive[headId]) {
+        return; // Slot laid out before one of them died
+    }
+    SetRadioSleep(memberId, false);
+    ChargeEnergy(memberId, engine.TransmitEnergy(memberId, headId, config.payloadBytes, 0.1));
+    if (engine.IsAbstractRadio()) {
+        leach::AbstractLinkTable& links = engine.GetLinkTable();
+        double distance = nodeState.linkDistance[memberId];
+        if (links.Deliver(distance)) {
+            roundScheduler.Schedule(Seconds(links.GetDelay(config.payloadBytes, distance)),
+                                    leach::Profiled(leach::EVENT_LINK_DELIVERY, &DeliverReading, headId));
+        }
+        return;
+    }
+    engine.ApplyLinkTxPower(memberId);
+    Ptr<NetDevice> member = engine.GetDevice(memberId);
+    member->Send(Create<Packet>(config.payloadBytes), engine.GetDevice(headId)->GetAddress(), readingProtocol); // ReceiveReading charges the head
+    roundScheduler.Schedule(Seconds(slotLength), leach::Profiled(leach::EVENT_RADIO_SLEEP, &SetRadioSleep, memberId, true));
 }
 
-// Energy model setup
-EnergySourceContainer SetupEnergyModel(NodeContainer nodes, NetDeviceContainer devices) {
-    BasicEnergySourceHelper energySourceHelper;
-    energySourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(100.0));
-
-    EnergySourceContainer energySources = energySourceHelper.Install(nodes);
+// A member reading reaches its head
+void DeliverReading(uint32_t headId) {
+    if (!nodeState.alive[headId]) {
+        return;
+    }
+    ChargeEnergy(headId, engine.ReceiveEnergy(config.payloadBytes));
+    aggregator.Collect(headId, config.payloadBytes);
+}
 
-    WifiRadioEnergyModelHelper radioEnergyHelper;
-    radioEnergyHelper.Set("TxCurrentA", DoubleValue(0.017));
-    radioEnergyHelper.Set("RxCurrentA", DoubleValue(0.019));
-    radioEnergyHelper.Install(devices, energySources);
+// A reading reaches a node's device once it is on the air; a collision or a
+// lost link means it never does. Only a node that still heads a cluster keeps it.
+void ReceiveReading(uint32_t nodeId, Ptr<NetDevice>, Ptr<const Packet>, uint16_t,
+                    const Address&, const Address&, NetDevice::PacketType) {
+    if (nodeState.IsClusterHead(nodeId)) {
+        DeliverReading(nodeId);
+    }
+}
 
-    for (uint32_t i = 0; i < energySources.GetN(); i++) {
-        lastReportedEnergy[i] = energySources.Get(i)->GetRemainingEnergy();
+// The head fuses the frame's readings with its own and sends one uplink, charged
+// by the energy model for the aggregated size
+void HeadUplink(uint32_t headId) {
+    if (!nodeState.alive[headId]) {
+        return; // Its cluster moved to a successor or to the neighbouring heads
+    }
+    uint32_t transmissionCount = aggregator.GetPendingPayloads(headId);
+    aggregator.Collect(headId, config.payloadBytes); // Head's own reading
+
+    uint32_t fusedBytes = aggregator.Fuse(headId);
+    engine.ForwardUplink(headId, fusedBytes, config.uplinkCost, &ChargeEnergy);
+    if (!engine.IsAbstractRadio()) {
+        Ptr<NetDevice> clusterHead = engine.GetDevice(headId);
+        engine.ApplyLinkTxPower(headId); // Uplink range, not the cluster's
+        clusterHead->Send(Create<Packet>(fusedBytes), engine.GetUplinkTarget(headId)->GetAddress(), aggregateProtocol);
     }
+    NS_LOG_DEBUG("Cluster Head " << headId << " fused " << transmissionCount
+                 << " member transmissions into a " << fusedBytes << " byte uplink.");
+}
+
+// Batch inter-cluster communication
+void BatchInterClusterCommunication(uint32_t baseStationId) {
+    uint32_t clusterHeadTransmissionCount = clusters.size();
+    NS_LOG_INFO("Base Station " << baseStationId << " received data from " << clusterHeadTransmissionCount << " cluster heads ("
+                << aggregator.GetCollectedPayloads() << " readings in " << aggregator.GetFusedPackets()
+                << " fused packets so far).");
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_BATCH_INTER_CLUSTER, &BatchInterClusterCommunication, baseStationId)); // Schedule next report
+}
 
-    return energySources;
+// Schedule cluster formation and periodic reporting
+void ScheduleClusterFormation() {
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_ELECT_CLUSTER_HEADS, &ElectClusterHeads));
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_FORM_CLUSTERS, &leach::ProtocolEngine::FormClusters, &engine));
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_SETUP_TDMA_SCHEDULE, &SetupTdmaSchedule));
+    Simulator::Schedule(Seconds(50.0), leach::Profiled(leach::EVENT_LOG_ENERGY_LEVELS, &LogEnergyLevels)); // Log energy levels every 50 seconds
+    Simulator::Schedule(Seconds(50.0), leach::Profiled(leach::EVENT_SCHEDULE_CLUSTER_FORMATION, &ScheduleClusterFormation)); // Schedule next formation
 }
 
-// Set node mobility
-void SetMobility(NodeContainer nodes) {
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
-        positionAlloc->Add(Vector(10.0 * i, 10.0 * i, 0.0));
+// Log energy levels only when there's a significant change
+void LogEnergyLevels() {
+    engine.SyncEnergy();
+    for (uint32_t i = 0; i < nodeState.GetN(); i++) {
+        double currentEnergy = nodeState.energy[i];
+        double& lastReported = nodeState.lastReportedEnergy[i];
+        if ((lastReported - currentEnergy) >= (lastReported * 0.05)) {
+            leach::EventRecorder::Get().Record(leach::RECORD_LOW_ENERGY, i, leach::EventRecorder::kNone, currentEnergy);
+            energyTrace.Record(Simulator::Now().GetSeconds(), i, currentEnergy);
+            lastReported = currentEnergy;
+        }
     }
-    mobility.SetPositionAllocator(positionAlloc);
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(nodes);
 }
 
 int main(int argc, char *argv[]) {
+    uint32_t seed = 1;
+    uint64_t run = 1;
+    std::string energyTracePath;
+    std::string energyTraceText;
+    bool profile = false;
+    std::string profileJson;
+    std::string eventLogPath;
+    std::string eventLogText;
+    uint32_t eventRing = 0;
+
+    CommandLine cmd;
+    cmd.AddValue("seed", "RNG seed", seed);
+    cmd.AddValue("run", "RNG run number", run);
+    cmd.AddValue("energyTrace", "Binary energy trace file (empty to disable)", energyTracePath);
+    cmd.AddValue("energyTraceText", "Text export of the energy trace written at exit (empty to skip)", energyTraceText);
+    cmd.AddValue("profile", "Report wall time per phase and protocol event counts at exit", profile);
+    cmd.AddValue("profileJson", "Also write the profile as JSON to this file", profileJson);
+    cmd.AddValue("eventLog", "Binary log of protocol events, formatted only on export (empty to log through LeachEvents)", eventLogPath);
+    cmd.AddValue("eventLogText", "Text export of the event log written at exit (empty to skip)", eventLogText);
+    cmd.AddValue("eventRing", "Without --eventLog, keep the last N protocol events in memory and print them at exit (0 to log through LeachEvents)", eventRing);
+    config.energyModel = "basic"; // BasicEnergySource drained by the Wi-Fi radio model
+    config.AddValues(cmd);
+    cmd.Parse(argc, argv);
+    if (config.mobility != "static") {
+        NS_FATAL_ERROR("This variant never re-checks moving members; --mobility needs customexample3 or WSN_Leach_DSM");
+    }
+    if (profile || !profileJson.empty()) {
+        leach::Profiler::Get().Enable();
+    }
+    RngSeedManager::SetSeed(seed);
+    RngSeedManager::SetRun(run);
+
     LogComponentEnable("LeachDmsNetworkSimulation", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEngine", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEvents", LOG_LEVEL_INFO);
+    // Formatting every event through LeachEvents is the slow path; --eventLog or --eventRing skip it
+    if (!eventLogPath.empty() && !leach::EventRecorder::Get().Open(eventLogPath)) {
+        NS_FATAL_ERROR("Cannot open event log " << eventLogPath);
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Enable(eventRing);
+    }
 
-    NodeContainer sensorNodes;
-    sensorNodes.Create(10);
+    engine.CreateNodes();
 
-    NodeContainer baseStationContainer;
-    baseStationContainer.Create(1);
-    Ptr<Node> baseStation = baseStationContainer.Get(0);
+    {
+        leach::Profiler::ScopedPhase phase("SetupNodes");
+        engine.SetupNodes();
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetupEnergyModel");
+        engine.SetupEnergyModel();
+    }
+    energyMonitor.SetDepletionCallback(MakeCallback(&ReportDepletion));
+    EnergySourceContainer energySources = engine.GetEnergySources(); // Empty under the manual model
+    for (uint32_t i = 0; i < energySources.GetN(); ++i) {
+        energyMonitor.Subscribe(i, DynamicCast<BasicEnergySource>(energySources.Get(i)));
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetMobility");
+        engine.SetMobility();
+    }
+    if (!engine.IsAbstractRadio()) {
+        for (uint32_t i = 0; i < config.numNodes; ++i) {
+            engine.GetNode(i)->RegisterProtocolHandler(MakeBoundCallback(&ReceiveReading, i), readingProtocol, engine.GetDevice(i));
+        }
+    }
+    aggregator.Resize(config.numNodes);
+    aggregator.SetCorrelation(config.aggregationCorrelation);
+    tdma.SetFrameLength(config.frameLength);
 
-    NetDeviceContainer devices;
-    SetupNodes(sensorNodes, devices);
-    EnergySourceContainer energySources = SetupEnergyModel(sensorNodes, devices);
-    SetMobility(sensorNodes);
+    if (!energyTracePath.empty() && !energyTrace.Open(energyTracePath)) {
+        NS_FATAL_ERROR("Cannot open energy trace " << energyTracePath);
+    }
 
-    ScheduleClusterFormation(sensorNodes, energySources);
-    BatchIntraClusterCommunication(sensorNodes); // Start periodic intra-cluster logging
-    BatchInterClusterCommunication(sensorNodes, baseStation); // Start periodic inter-cluster logging
+    ScheduleClusterFormation();
+    BatchIntraClusterCommunication(); // Start the per-frame fused uplinks
+    BatchInterClusterCommunication(engine.GetBaseStationId()); // Start periodic inter-cluster logging
 
-    Simulator::Stop(Seconds(600.0));
-    Simulator::Run();
+    Simulator::Stop(Seconds(config.duration));
+    leach::Profiler::Get().RunSimulator();
     Simulator::Destroy();
+    leach::Profiler::Get().Finish(profileJson);
+    energyTrace.Close();
+    int status = 0; // The run is complete; a failed export is reported without cutting the other one short
+    if (!energyTracePath.empty() && !energyTraceText.empty() &&
+        !leach::EnergyTraceWriter::ExportText(energyTracePath, energyTraceText)) {
+        NS_LOG_ERROR("Cannot export energy trace " << energyTracePath << " to " << energyTraceText);
+        status = 1;
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Dump(std::clog);
+    }
+    leach::EventRecorder::Get().Close();
+    if (!eventLogPath.empty() && !eventLogText.empty() &&
+        !leach::EventRecorder::ExportText(eventLogPath, eventLogText)) {
+        NS_LOG_ERROR("Cannot export event log " << eventLogPath << " to " << eventLogText);
+        status = 1;
+    }
 
-    return 0;
+    return status;
 }
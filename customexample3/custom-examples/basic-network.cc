@@ -4,271 +4,239 @@
 #include "ns3/wifi-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/energy-module.h"
-#include <map>
+#include <iostream>
 #include <vector>
-#include <cmath>
+
+#include "data-aggregator.h"
+#include "energy-trace-writer.h"
+#include "event-recorder.h"
+#include "lifetime-statistics.h"
+#include "profiler.h"
+#include "protocol-engine.h"
+#include "simulation-config.h"
+#include "tick-group.h"
 
 using namespace ns3;
 using namespace ns3::energy;
 
 NS_LOG_COMPONENT_DEFINE("LeachDmsNetworkSimulation");
 
-// Cluster structure with backup cluster head
-struct Cluster {
-    Ptr<Node> clusterHead;
-    Ptr<Node> backupHead; // Backup cluster head
-    std::vector<Ptr<Node>> members;
-};
-
-std::map<uint32_t, Cluster> clusters;
-std::map<uint32_t, double> nodeEnergyLevels; // Map to track energy levels manually
-double clusterHeadProbability = 0.2;
-double initialEnergy = 100.0;
-
-void ClearClusters();
-void ElectClusterHeads(NodeContainer nodes);
-void FormClusters(NodeContainer nodes);
-void SetupClusterCommunications(NodeContainer nodes, Ptr<Node> baseStation);
-void ScheduleClusterFormation(NodeContainer nodes);
-void IntraClusterCommunication(Ptr<Node> memberNode, Ptr<Node> clusterHead);
-void InterClusterCommunication(Ptr<Node> clusterHead, Ptr<Node> baseStation);
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices);
-void InitializeNodeEnergyLevels(NodeContainer nodes);
+leach::SimulationConfig config; // Node count, field, p, duration, energy and policies from the command line
+leach::ProtocolEngine engine(config); // Node setup, energy, election, formation, repair and backup heads
+leach::NodeStateTable& nodeState = engine.GetState(); // Per-node energy (tracked manually), role and liveness
+std::vector<leach::Cluster>& clusters = engine.GetClusters(); // Clusters of the current round, in election order
+leach::TickGroup frameTicks(leach::EVENT_CLUSTER_FRAME); // Serving heads, all framed by one event per frame
+leach::DataAggregator aggregator; // Member readings buffered at each head until the frame's uplink
+leach::EnergyTraceWriter energyTrace; // Buffered binary (time, node, energy) samples
+leach::LifetimeStatistics lifetime; // Node failures, heads per round and residual energy, printed at exit
+
+void ElectClusterHeads();
+void SetupClusterCommunications();
+void ScheduleClusterFormation();
+void IntraClusterCommunication(uint32_t memberId, uint32_t headId, double txPower);
+void LogLowEnergy(uint32_t nodeId, double energyBefore);
+void InterClusterCommunication(uint32_t headId);
+void ClusterFrame(uint32_t headId);
 void UpdateEnergy(uint32_t nodeId, double energyUsed);
-double CalculateTransmissionPower(double distance);
-void SetMobility(NodeContainer nodes);
-void CheckNodeFailure(NodeContainer nodes);
-void ScheduleFailureCheck(NodeContainer nodes);
-Ptr<Node> FindNodeWithHighEnergy(const std::vector<Ptr<Node>>& members);
-
-// Initialize energy levels for each node
-void InitializeNodeEnergyLevels(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        nodeEnergyLevels[node->GetId()] = initialEnergy;
-    }
-}
+void CheckNodeFailure();
+void ScheduleFailureCheck();
 
 // Function to log and update energy level
 void UpdateEnergy(uint32_t nodeId, double energyUsed) {
-    if (nodeEnergyLevels.find(nodeId) != nodeEnergyLevels.end()) {
-        nodeEnergyLevels[nodeId] = std::max(0.0, nodeEnergyLevels[nodeId] - energyUsed);
-        
-        // Only log energy levels below 10 J to reduce log size
-        if (nodeEnergyLevels[nodeId] < 10.0) {
-            NS_LOG_INFO("Node " << nodeId << " energy level: " << nodeEnergyLevels[nodeId] << " J");
-        }
+    if (nodeId < nodeState.GetN()) {
+        engine.UpdateEnergy(nodeId, energyUsed);
+        LogLowEnergy(nodeId, 0.0);
     }
 }
 
-// DMS Function to determine transmission power based on distance
-double CalculateTransmissionPower(double distance) {
-    double basePower = 1.0; // Base power level
-    if (distance > 50.0) {
-        return basePower * 1.5; // Higher power for long distances
-    } else if (distance > 20.0) {
-        return basePower * 1.2; // Moderate power for medium distances
-    } else {
-        return basePower * 0.8; // Lower power for short distances
+// Only log energy levels below 10 J to reduce log size
+void LogLowEnergy(uint32_t nodeId, double) {
+    double energy = nodeState.energy[nodeId];
+    if (energy < 10.0) {
+        leach::EventRecorder::Get().Record(leach::RECORD_LOW_ENERGY, nodeId, leach::EventRecorder::kNone, energy);
+        energyTrace.Record(Simulator::Now().GetSeconds(), nodeId, energy);
     }
 }
 
-// Clear previous clusters
-void ClearClusters() {
-    clusters.clear();
+// Intra-cluster communication with DMS applied; the reading is buffered at the
+// head, and ClusterFrame charges the member's transmission and the head's reception
+void IntraClusterCommunication(uint32_t memberId, uint32_t headId, double txPower) {
+    leach::EventRecorder::Get().Record(leach::RECORD_MEMBER_REPORT, memberId, headId, txPower);
+    aggregator.Collect(headId, config.payloadBytes);
 }
 
-// Elect cluster heads with backup designation
-void ElectClusterHeads(NodeContainer nodes) {
-    ClearClusters();
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        
-        if ((double)rand() / RAND_MAX <= clusterHeadProbability && nodeEnergyLevels[node->GetId()] > 10.0) {
-            Cluster newCluster;
-            newCluster.clusterHead = node;
-            clusters[node->GetId()] = newCluster;
-
-            // Select a backup cluster head with high energy within the cluster
-            Ptr<Node> backup = FindNodeWithHighEnergy(newCluster.members);
-            if (backup) {
-                clusters[node->GetId()].backupHead = backup;
-            }
-
-            NS_LOG_INFO("Node " << node->GetId() << " elected as cluster head with backup: "
-                                << (backup ? backup->GetId() : -1));
-        }
+// Inter-cluster communication with DMS applied: one fused uplink per frame
+void InterClusterCommunication(uint32_t headId) {
+    uint32_t fusedBytes = aggregator.Fuse(headId);
+    if (fusedBytes == 0) {
+        return;
     }
-}
+    leach::EventRecorder::Get().Record(leach::RECORD_HEAD_UPLINK, headId, engine.GetNextHop(headId), fusedBytes);
 
-// Utility function to find a node with high energy to act as backup
-Ptr<Node> FindNodeWithHighEnergy(const std::vector<Ptr<Node>>& members) {
-    Ptr<Node> backupNode = nullptr;
-    double maxEnergy = 0.0;
-    for (auto& member : members) {
-        double memberEnergy = nodeEnergyLevels[member->GetId()];
-        if (memberEnergy > maxEnergy) {
-            maxEnergy = memberEnergy;
-            backupNode = member;
-        }
-    }
-    return backupNode;
+    // Deduct energy based on transmission power and aggregated size at every hop to the base station
+    engine.ForwardUplink(headId, fusedBytes, config.uplinkCost, &UpdateEnergy);
 }
 
-// Form clusters around cluster heads
-void FormClusters(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        if (clusters.find(node->GetId()) == clusters.end()) {  // Only add non-cluster-head nodes
-            double minDistance = std::numeric_limits<double>::max();
-            Ptr<Node> closestClusterHead = nullptr;
-            
-            for (auto& entry : clusters) {
-                Ptr<Node> clusterHead = entry.second.clusterHead;
-                double distance = node->GetObject<MobilityModel>()->GetDistanceFrom(clusterHead->GetObject<MobilityModel>());
-                
-                if (distance < minDistance) {
-                    minDistance = distance;
-                    closestClusterHead = clusterHead;
-                }
-            }
-            
-            if (closestClusterHead) {
-                clusters[closestClusterHead->GetId()].members.push_back(node);
-                NS_LOG_INFO("Node " << node->GetId() << " joined cluster with head " << closestClusterHead->GetId());
-            }
-        }
+// One TDMA frame of a cluster: members report, the head adds its own reading and sends one uplink
+void ClusterFrame(uint32_t headId) {
+    engine.UpdateMobileNodes(); // Re-homes moving members; free while nobody crossed a boundary
+    if (!nodeState.IsClusterHead(headId)) {
+        return; // A new round is being set up
     }
+    engine.ChargeClusterFrame(headId, config.payloadBytes, 0.1,
+                              [headId](uint32_t memberId, double txPower) {
+                                  IntraClusterCommunication(memberId, headId, txPower);
+                              },
+                              &LogLowEnergy);
+    aggregator.Collect(headId, config.payloadBytes);
+    InterClusterCommunication(headId);
 }
 
-// Intra-cluster communication with DMS applied
-void IntraClusterCommunication(Ptr<Node> memberNode, Ptr<Node> clusterHead) {
-    double distance = memberNode->GetObject<MobilityModel>()->GetDistanceFrom(clusterHead->GetObject<MobilityModel>());
-    double txPower = CalculateTransmissionPower(distance);
-
-    NS_LOG_INFO("Node " << memberNode->GetId() << " sends data to Cluster Head " << clusterHead->GetId()
-                << " with power level: " << txPower);
-
-    // Deduct energy based on transmission power
-    UpdateEnergy(memberNode->GetId(), 0.1 * txPower); // Deduct energy based on power level
-
-    Simulator::Schedule(Seconds(1.0), &IntraClusterCommunication, memberNode, clusterHead);
-}
-
-// Inter-cluster communication with DMS applied
-void InterClusterCommunication(Ptr<Node> clusterHead, Ptr<Node> baseStation) {
-    double distance = clusterHead->GetObject<MobilityModel>()->GetDistanceFrom(baseStation->GetObject<MobilityModel>());
-    double txPower = CalculateTransmissionPower(distance);
-
-    NS_LOG_INFO("Cluster Head " << clusterHead->GetId() << " sends aggregated data to Base Station with power level: " 
-                << txPower);
-
-    // Deduct energy based on transmission power
-    UpdateEnergy(clusterHead->GetId(), 0.2 * txPower); // Deduct energy based on power level
-
-    Simulator::Schedule(Seconds(5.0), &InterClusterCommunication, clusterHead, baseStation);
+// Elect this round's heads and count them for the heads-per-round statistics
+void ElectClusterHeads() {
+    engine.ElectClusterHeads();
+    lifetime.OnRound(clusters.size());
 }
 
 // Schedule cluster formation
-void ScheduleClusterFormation(NodeContainer nodes) {
-    Simulator::Schedule(Seconds(20.0), &ElectClusterHeads, nodes);
-    Simulator::Schedule(Seconds(20.0), &FormClusters, nodes);
-    Simulator::Schedule(Seconds(20.0), &SetupClusterCommunications, nodes, nodes.Get(0)); // Base station as node 0
-    Simulator::Schedule(Seconds(20.0), &ScheduleClusterFormation, nodes);
+void ScheduleClusterFormation() {
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_ELECT_CLUSTER_HEADS, &ElectClusterHeads));
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_FORM_CLUSTERS, &leach::ProtocolEngine::FormClusters, &engine));
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_SETUP_CLUSTER_COMMUNICATIONS, &SetupClusterCommunications));
+    Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_SCHEDULE_CLUSTER_FORMATION, &ScheduleClusterFormation));
 }
 
 // Set up communication within and between clusters
-void SetupClusterCommunications(NodeContainer nodes, Ptr<Node> baseStation) {
-    for (auto& entry : clusters) {
-        Ptr<Node> clusterHead = entry.second.clusterHead;
-        
-        for (Ptr<Node> member : entry.second.members) {
-            IntraClusterCommunication(member, clusterHead);
-        }
-
-        InterClusterCommunication(clusterHead, baseStation);
+void SetupClusterCommunications() {
+    engine.SetupUplinks();
+    frameTicks.Clear();
+    for (const leach::Cluster& cluster : clusters) {
+        frameTicks.Add(cluster.clusterHead);
     }
+    frameTicks.Start(); // First frame now; later rounds join the running tick
 }
 
 // Simulate node failure by removing failed nodes from clusters
-void CheckNodeFailure(NodeContainer nodes) {
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
-        Ptr<Node> node = *it;
-        uint32_t nodeId = node->GetId();
-
-        // Simulate failure if energy is below threshold
-        if (nodeEnergyLevels[nodeId] < 5.0) {
-            NS_LOG_INFO("Node " << nodeId << " has failed due to low energy.");
-            for (auto &entry : clusters) {
-                auto &members = entry.second.members;
-                members.erase(std::remove(members.begin(), members.end(), node), members.end());
+void CheckNodeFailure() {
+    // Linear scan of the energy column; each node is reported once, when it first drops below 5 J
+    std::vector<uint32_t> failed;
+    nodeState.CollectFailures(5.0, failed);
+
+    // Repair only the clusters these nodes belong to; a full re-election waits for the round boundary
+    for (uint32_t nodeId : failed) {
+        leach::EventRecorder::Get().Record(leach::RECORD_NODE_FAILED, nodeId);
+        lifetime.OnNodeDeath(Simulator::Now().GetSeconds()); // May stop the run after this check
+        if (nodeState.IsClusterHead(nodeId)) {
+            uint32_t cluster = nodeState.clusterIndex[nodeId];
+            frameTicks.Remove(nodeId);
+            if (engine.PromoteBackupHead(nodeId)) {
+                frameTicks.Add(clusters[cluster].clusterHead); // The successor frames from the next tick
+            } else {
+                engine.RepairCluster(nodeId);
             }
+        } else if (nodeState.role[nodeId] == leach::ROLE_MEMBER) {
+            engine.RemoveMember(nodeId);
         }
     }
 }
 
 // Periodically check for node failures
-void ScheduleFailureCheck(NodeContainer nodes) {
-    Simulator::Schedule(Seconds(10.0), &CheckNodeFailure, nodes);
-    Simulator::Schedule(Seconds(10.0), &ScheduleFailureCheck, nodes);  // Re-schedule to keep checking
-}
-
-// Basic node setup
-void SetupNodes(NodeContainer nodes, NetDeviceContainer& devices) {
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
-
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper wifiPhy;
-    wifiPhy.SetChannel(wifiChannel.Create());
-
-    WifiMacHelper wifiMac;
-    wifiMac.SetType("ns3::AdhocWifiMac");
-
-    devices = wifi.Install(wifiPhy, wifiMac, nodes);
-
-    InternetStackHelper stack;
-    stack.Install(nodes);
-
-    Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    address.Assign(devices);
+void ScheduleFailureCheck() {
+    Simulator::Schedule(Seconds(10.0), leach::Profiled(leach::EVENT_CHECK_NODE_FAILURE, &CheckNodeFailure));
+    Simulator::Schedule(Seconds(10.0), leach::Profiled(leach::EVENT_SCHEDULE_FAILURE_CHECK, &ScheduleFailureCheck));  // Re-schedule to keep checking
 }
 
-// Set node mobility
-void SetMobility(NodeContainer nodes) {
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
-        positionAlloc->Add(Vector(10.0 * i, 10.0 * i, 0.0));
+int main(int argc, char *argv[]) {
+    uint32_t seed = 1;
+    uint64_t run = 1;
+    std::string energyTracePath;
+    std::string energyTraceText;
+    bool profile = false;
+    std::string profileJson;
+    std::string eventLogPath;
+    std::string eventLogText;
+    uint32_t eventRing = 0;
+
+    CommandLine cmd;
+    cmd.AddValue("seed", "RNG seed", seed);
+    cmd.AddValue("run", "RNG run number", run);
+    cmd.AddValue("energyTrace", "Binary trace of low-energy (< 10 J) samples (empty to disable)", energyTracePath);
+    cmd.AddValue("energyTraceText", "Text export of the energy trace written at exit (empty to skip)", energyTraceText);
+    cmd.AddValue("profile", "Report wall time per phase and protocol event counts at exit", profile);
+    cmd.AddValue("profileJson", "Also write the profile as JSON to this file", profileJson);
+    cmd.AddValue("eventLog", "Binary log of protocol events, formatted only on export (empty to log through LeachEvents)", eventLogPath);
+    cmd.AddValue("eventLogText", "Text export of the event log written at exit (empty to skip)", eventLogText);
+    cmd.AddValue("eventRing", "Without --eventLog, keep the last N protocol events in memory and print them at exit (0 to log through LeachEvents)", eventRing);
+    config.backupHeads = true; // This variant keeps a successor for every head
+    config.AddValues(cmd);
+    cmd.Parse(argc, argv);
+    if (profile || !profileJson.empty()) {
+        leach::Profiler::Get().Enable();
     }
-    mobility.SetPositionAllocator(positionAlloc);
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(nodes);
-}
+    RngSeedManager::SetSeed(seed);
+    RngSeedManager::SetRun(run);
 
-int main(int argc, char *argv[]) {
     LogComponentEnable("LeachDmsNetworkSimulation", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEngine", LOG_LEVEL_INFO);
+    LogComponentEnable("LeachEvents", LOG_LEVEL_INFO);
+    // Formatting every event through LeachEvents is the slow path; --eventLog or --eventRing skip it
+    if (!eventLogPath.empty() && !leach::EventRecorder::Get().Open(eventLogPath)) {
+        NS_FATAL_ERROR("Cannot open event log " << eventLogPath);
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Enable(eventRing);
+    }
 
-    NodeContainer sensorNodes;
-    sensorNodes.Create(10);
-
-    NodeContainer baseStationContainer;
-    baseStationContainer.Create(1);
-    Ptr<Node> baseStation = baseStationContainer.Get(0);
-
-    NetDeviceContainer devices;
-    SetupNodes(sensorNodes, devices);
-    SetMobility(sensorNodes);
+    engine.CreateNodes();
 
-    InitializeNodeEnergyLevels(sensorNodes); // Initialize manual energy tracking
+    {
+        leach::Profiler::ScopedPhase phase("SetupNodes");
+        engine.SetupNodes();
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetupEnergyModel");
+        engine.SetupEnergyModel(); // Initialize manual energy tracking
+    }
+    {
+        leach::Profiler::ScopedPhase phase("SetMobility");
+        engine.SetMobility();
+    }
+    aggregator.Resize(config.numNodes);
+    aggregator.SetCorrelation(config.aggregationCorrelation);
+    frameTicks.Resize(config.numNodes);
+    frameTicks.SetPeriod(config.frameLength);
+    frameTicks.SetCallback(MakeCallback(&ClusterFrame));
+
+    if (!energyTracePath.empty() && !energyTrace.Open(energyTracePath)) {
+        NS_FATAL_ERROR("Cannot open energy trace " << energyTracePath);
+    }
 
-    ScheduleClusterFormation(sensorNodes);
-    ScheduleFailureCheck(sensorNodes); // Schedule periodic failure checks
+    ScheduleClusterFormation();
+    ScheduleFailureCheck(); // Schedule periodic failure checks
 
-    Simulator::Stop(Seconds(600.0));
-    Simulator::Run();
+    lifetime.Reset(config.numNodes, config.initialEnergy, config.stopDeadFraction);
+    Simulator::Stop(Seconds(config.duration));
+    leach::Profiler::Get().RunSimulator();
+    lifetime.SampleEnergy(nodeState.energy);
     Simulator::Destroy();
+    lifetime.Print(std::cout);
+    leach::Profiler::Get().Finish(profileJson);
+    energyTrace.Close();
+    int status = 0; // The run is complete; a failed export is reported without cutting the other one short
+    if (!energyTracePath.empty() && !energyTraceText.empty() &&
+        !leach::EnergyTraceWriter::ExportText(energyTracePath, energyTraceText)) {
+        NS_LOG_ERROR("Cannot export energy trace " << energyTracePath << " to " << energyTraceText);
+        status = 1;
+    }
+    if (eventLogPath.empty() && eventRing > 0) {
+        leach::EventRecorder::Get().Dump(std::clog);
+    }
+    leach::EventRecorder::Get().Close();
+    if (!eventLogPath.empty() && !eventLogText.empty() &&
+        !leach::EventRecorder::ExportText(eventLogPath, eventLogText)) {
+        NS_LOG_ERROR("Cannot export event log " << eventLogPath << " to " << eventLogText);
+        status = 1;
+    }
 
-    return 0;
+    return status;
 }
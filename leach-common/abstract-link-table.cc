@@ -0,0 +1,80 @@
+#include "abstract-link-table.h"
+
+#include "ns3/fatal-error.h"
+
+#include <sstream>
+
+namespace leach {
+
+namespace {
+
+const double kSpeedOfLight = 299792458.0; // m/s
+
+} // namespace
+
+AbstractLinkTable::AbstractLinkTable() : m_dataRate(1e6), m_draws(0) {}
+
+void AbstractLinkTable::SetBands(const std::string& bands) {
+    m_maxDistance.clear();
+    m_loss.clear();
+    std::istringstream in(bands);
+    std::string band;
+    while (std::getline(in, band, ',')) {
+        std::istringstream fields(band);
+        double maxDistance = 0.0;
+        double loss = 0.0;
+        char colon = 0;
+        if (!(fields >> maxDistance >> colon >> loss) || colon != ':' || loss < 0.0 || loss > 1.0) {
+            NS_FATAL_ERROR("Malformed link band '" << band << "'; expected maxDistance:loss with loss in [0, 1]");
+        }
+        if (!m_maxDistance.empty() && maxDistance <= m_maxDistance.back()) {
+            NS_FATAL_ERROR("Link bands must be in increasing distance: '" << bands << "'");
+        }
+        m_maxDistance.push_back(maxDistance);
+        m_loss.push_back(loss);
+    }
+}
+
+void AbstractLinkTable::SetDataRate(double bitsPerSecond) {
+    m_dataRate = bitsPerSecond;
+}
+
+int64_t AbstractLinkTable::AssignStreams(int64_t stream) {
+    if (!m_uniform) {
+        m_uniform = ns3::CreateObject<ns3::UniformRandomVariable>(); // Not at static init: engines are often globals
+    }
+    m_uniform->SetStream(stream);
+    m_draws = 0;
+    return 1;
+}
+
+double AbstractLinkTable::GetLossProbability(double distance) const {
+    for (std::size_t i = 0; i < m_maxDistance.size(); ++i) {
+        if (distance <= m_maxDistance[i]) {
+            return m_loss[i];
+        }
+    }
+    return 1.0; // Out of range
+}
+
+bool AbstractLinkTable::Deliver(double distance) {
+    double loss = GetLossProbability(distance);
+    if (loss <= 0.0) {
+        return true; // Keep the stream untouched on lossless links
+    }
+    m_draws++;
+    return m_uniform->GetValue() >= loss;
+}
+
+void AbstractLinkTable::Skip(uint64_t draws) {
+    for (uint64_t i = 0; i < draws; ++i) {
+        m_uniform->GetValue();
+    }
+    m_draws += draws;
+}
+
+double AbstractLinkTable::GetDelay(uint32_t bytes, double distance) const {
+    return 8.0 * bytes / m_dataRate + distance / kSpeedOfLight;
+}
+
+} // namespace leach
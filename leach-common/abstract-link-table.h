@@ -0,0 +1,57 @@
+#ifndef LEACH_ABSTRACT_LINK_TABLE_H
+#define LEACH_ABSTRACT_LINK_TABLE_H
+
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+// Analytic stand-in for the Wi-Fi channel in abstract-radio mode: a packet
+// over a link of length d is lost with the probability of the first distance
+// band that covers d (always beyond the last band) and otherwise arrives after
+// its airtime at the configured rate plus the propagation delay.
+class AbstractLinkTable {
+public:
+    AbstractLinkTable();
+
+    // Parse "maxDistance:loss,..." in increasing distance, e.g. "50:0,100:0.02";
+    // fatal on malformed or unordered bands
+    void SetBands(const std::string& bands);
+
+    void SetDataRate(double bitsPerSecond);
+
+    // Pin the loss draws to one RNG stream; returns the number of streams used.
+    // Must be called before Deliver
+    int64_t AssignStreams(int64_t stream);
+
+    double GetLossProbability(double distance) const;
+
+    // Draw whether a packet over a link of this length arrives
+    bool Deliver(double distance);
+
+    // Loss draws so far: the stream's position for checkpoints
+    uint64_t GetDrawCount() const {
+        return m_draws;
+    }
+
+    // Advance the loss stream by the given number of draws
+    void Skip(uint64_t draws);
+
+    // Airtime plus propagation delay (s)
+    double GetDelay(uint32_t bytes, double distance) const;
+
+private:
+    std::vector<double> m_maxDistance; // Upper edge of each band (m)
+    std::vector<double> m_loss;        // Loss probability within it
+    double m_dataRate;                 // bit/s
+    uint64_t m_draws;                  // Loss draws since AssignStreams
+    ns3::Ptr<ns3::UniformRandomVariable> m_uniform;
+};
+
+} // namespace leach
+
+#endif // LEACH_ABSTRACT_LINK_TABLE_H
@@ -0,0 +1,76 @@
+#include "checkpoint.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace leach {
+
+namespace {
+
+const char kMagic[8] = {'L', 'E', 'A', 'C', 'H', 'C', 'K', '1'};
+
+template <class T>
+void WriteValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+void WriteColumn(std::ofstream& out, const std::vector<T>& column) {
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+template <class T>
+bool ReadValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <class T>
+bool ReadColumn(std::ifstream& in, std::vector<T>& column, uint32_t count) {
+    column.resize(count);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(column.data()), count * sizeof(T)));
+}
+
+} // namespace
+
+bool Checkpoint::Write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    uint32_t n = static_cast<uint32_t>(energy.size());
+    uint32_t clusters = static_cast<uint32_t>(heads.size());
+    out.write(kMagic, sizeof(kMagic));
+    WriteValue(out, time);
+    WriteValue(out, firstDeathTime);
+    WriteValue(out, round);
+    WriteValue(out, seed);
+    WriteValue(out, run);
+    WriteValue(out, linkDraws);
+    WriteValue(out, n);
+    WriteValue(out, clusters);
+    WriteColumn(out, energy);
+    WriteColumn(out, alive);
+    WriteColumn(out, headThisEpoch);
+    WriteColumn(out, clusterHead);
+    WriteColumn(out, streamDraws);
+    WriteColumn(out, heads);
+    WriteColumn(out, backups);
+    return out.good();
+}
+
+bool Checkpoint::Read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    uint32_t n = 0;
+    uint32_t clusters = 0;
+    return ReadValue(in, time) && ReadValue(in, firstDeathTime) && ReadValue(in, round) && ReadValue(in, seed) &&
+           ReadValue(in, run) && ReadValue(in, linkDraws) && ReadValue(in, n) && ReadValue(in, clusters) &&
+           ReadColumn(in, energy, n) && ReadColumn(in, alive, n) && ReadColumn(in, headThisEpoch, n) &&
+           ReadColumn(in, clusterHead, n) && ReadColumn(in, streamDraws, n) && ReadColumn(in, heads, clusters) &&
+           ReadColumn(in, backups, clusters);
+}
+
+} // namespace leach
@@ -0,0 +1,49 @@
+#ifndef LEACH_CHECKPOINT_H
+#define LEACH_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+// Protocol state of a run at one instant, enough to resume it without
+// replaying the warm-up. ns-3 does not expose its RNG state, so a stream's
+// position is the number of values drawn from it; restoring replays that many
+// draws, which is far cheaper than the simulated time they stand for.
+//
+//   header:   "LEACHCK1"
+//   scalars:  double time | double firstDeathTime | uint32 round | uint32 seed |
+//             uint64 run | uint64 linkDraws | uint32 n | uint32 clusters
+//   nodes:    double energy[n] | uint8 alive[n] | uint8 headThisEpoch[n] |
+//             uint32 clusterHead[n] | uint64 streamDraws[n]
+//   clusters: uint32 head[clusters] | uint32 backup[clusters]
+//
+// Values are stored in host byte order, like the energy trace.
+struct Checkpoint {
+    static constexpr uint32_t kNone = 0xffffffffu;
+
+    double time = 0.0;                  // Simulated seconds at the snapshot
+    double firstDeathTime = -1.0;       // First node death so far, or -1
+    uint32_t round = 0;                 // Elections held so far
+    uint32_t seed = 0;                  // RngSeedManager seed and run the run used
+    uint64_t run = 0;
+    uint64_t linkDraws = 0;             // Abstract link table loss draws
+    std::vector<double> energy;         // Per node (J)
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> headThisEpoch;
+    std::vector<uint32_t> clusterHead;  // Head of the node's cluster (itself for heads), or kNone
+    std::vector<uint64_t> streamDraws;  // Election stream position per node
+    std::vector<uint32_t> heads;        // Cluster heads in cluster order
+    std::vector<uint32_t> backups;      // Backup head per cluster, or kNone
+
+    // Returns false if path cannot be written
+    bool Write(const std::string& path) const;
+
+    // Returns false if path is missing, truncated or not a checkpoint
+    bool Read(const std::string& path);
+};
+
+} // namespace leach
+
+#endif // LEACH_CHECKPOINT_H
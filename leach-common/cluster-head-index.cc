@@ -0,0 +1,196 @@
+#include "cluster-head-index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace leach {
+
+namespace {
+
+// Same arithmetic as MobilityModel::GetDistanceFrom so both lookups agree bit for bit
+inline double Distance(double ax, double ay, double az, double bx, double by, double bz) {
+    double dx = ax - bx;
+    double dy = ay - by;
+    double dz = az - bz;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
+
+ClusterHeadIndex::ClusterHeadIndex()
+    : m_minX(0.0), m_minY(0.0), m_cellSize(1.0), m_cols(0), m_rows(0), m_live(0) {}
+
+void ClusterHeadIndex::Clear() {
+    m_entries.clear();
+    m_late.clear();
+    m_cellStart.clear();
+    m_cols = 0;
+    m_rows = 0;
+    m_live = 0;
+}
+
+void ClusterHeadIndex::Build(const std::vector<uint32_t>& headIds, const std::vector<ns3::Vector>& positions) {
+    Clear();
+    if (headIds.empty()) {
+        return;
+    }
+
+    double maxX = positions[0].x;
+    double maxY = positions[0].y;
+    m_minX = positions[0].x;
+    m_minY = positions[0].y;
+    for (const ns3::Vector& p : positions) {
+        m_minX = std::min(m_minX, p.x);
+        m_minY = std::min(m_minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    // Aim for about one head per cell; a degenerate extent collapses to a single row or column
+    double width = maxX - m_minX;
+    double height = maxY - m_minY;
+    double area = std::max(width, 1.0) * std::max(height, 1.0);
+    m_cellSize = std::max(std::sqrt(area / headIds.size()), 1e-6);
+    m_cols = static_cast<uint32_t>(width / m_cellSize) + 1;
+    m_rows = static_cast<uint32_t>(height / m_cellSize) + 1;
+
+    // Counting sort of heads into cells
+    std::vector<uint32_t> cellOf(headIds.size());
+    m_cellStart.assign(static_cast<std::size_t>(m_cols) * m_rows + 1, 0);
+    for (std::size_t i = 0; i < headIds.size(); ++i) {
+        cellOf[i] = CellY(positions[i].y) * m_cols + CellX(positions[i].x);
+        m_cellStart[cellOf[i] + 1]++;
+    }
+    for (std::size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_entries.resize(headIds.size());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t i = 0; i < headIds.size(); ++i) {
+        m_entries[fill[cellOf[i]]++] = Entry{headIds[i], positions[i].x, positions[i].y, positions[i].z};
+    }
+    m_live = m_entries.size();
+}
+
+bool ClusterHeadIndex::Remove(uint32_t headId, const ns3::Vector& position) {
+    if (m_live == 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < m_late.size(); ++i) {
+        if (m_late[i].id == headId) {
+            m_late.erase(m_late.begin() + i);
+            m_live--;
+            return true;
+        }
+    }
+    if (m_cellStart.empty()) {
+        return false;
+    }
+    std::size_t cell = static_cast<std::size_t>(CellY(position.y)) * m_cols + CellX(position.x);
+    for (uint32_t e = m_cellStart[cell]; e < m_cellStart[cell + 1]; ++e) {
+        if (m_entries[e].id == headId) {
+            m_entries[e].id = kNoHead;
+            m_live--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClusterHeadIndex::Insert(uint32_t headId, const ns3::Vector& position) {
+    m_late.push_back(Entry{headId, position.x, position.y, position.z});
+    m_live++;
+}
+
+uint32_t ClusterHeadIndex::CellX(double x) const {
+    double c = std::floor((x - m_minX) / m_cellSize);
+    return static_cast<uint32_t>(std::min<double>(std::max(c, 0.0), m_cols - 1));
+}
+
+uint32_t ClusterHeadIndex::CellY(double y) const {
+    double c = std::floor((y - m_minY) / m_cellSize);
+    return static_cast<uint32_t>(std::min<double>(std::max(c, 0.0), m_rows - 1));
+}
+
+uint32_t ClusterHeadIndex::FindNearest(const ns3::Vector& position, double* distance) const {
+    if (m_live == 0) {
+        return kNoHead;
+    }
+
+    uint32_t bestId = kNoHead;
+    double bestDistance = std::numeric_limits<double>::max();
+    for (const Entry& entry : m_late) {
+        double d = Distance(position.x, position.y, position.z, entry.x, entry.y, entry.z);
+        if (d < bestDistance || (d == bestDistance && entry.id < bestId)) {
+            bestDistance = d;
+            bestId = entry.id;
+        }
+    }
+
+    if (m_cellStart.empty()) {
+        if (distance) {
+            *distance = bestDistance;
+        }
+        return bestId; // Only late heads
+    }
+
+    // CellX and CellY clamp, so a query outside the heads' bounding box starts
+    // from the nearest edge cell
+    int64_t cx = CellX(position.x);
+    int64_t cy = CellY(position.y);
+    int64_t maxRing = std::max(m_cols, m_rows);
+    for (int64_t ring = 0; ring <= maxRing; ++ring) {
+        int64_t x0 = cx - ring;
+        int64_t x1 = cx + ring;
+        int64_t y0 = cy - ring;
+        int64_t y1 = cy + ring;
+        for (int64_t y = std::max<int64_t>(y0, 0); y <= std::min<int64_t>(y1, m_rows - 1); ++y) {
+            // Interior rows of the ring only contribute their two edge cells
+            bool edgeRow = (y == y0 || y == y1);
+            int64_t step = edgeRow ? 1 : x1 - x0;
+            for (int64_t x = x0; x <= x1; x += step) {
+                if (x < 0 || x >= m_cols) {
+                    continue;
+                }
+                std::size_t cell = static_cast<std::size_t>(y) * m_cols + x;
+                for (uint32_t e = m_cellStart[cell]; e < m_cellStart[cell + 1]; ++e) {
+                    const Entry& entry = m_entries[e];
+                    if (entry.id == kNoHead) {
+                        continue;
+                    }
+                    double d = Distance(position.x, position.y, position.z, entry.x, entry.y, entry.z);
+                    if (d < bestDistance || (d == bestDistance && entry.id < bestId)) {
+                        bestDistance = d;
+                        bestId = entry.id;
+                    }
+                }
+            }
+        }
+
+        // Unsearched cells lie beyond a side of the block that is still inside
+        // the grid, at least this far away; sides past the grid edge hide nothing
+        double bound = std::numeric_limits<double>::max();
+        if (x0 > 0) {
+            bound = std::min(bound, position.x - (m_minX + x0 * m_cellSize));
+        }
+        if (x1 < m_cols - 1) {
+            bound = std::min(bound, m_minX + (x1 + 1) * m_cellSize - position.x);
+        }
+        if (y0 > 0) {
+            bound = std::min(bound, position.y - (m_minY + y0 * m_cellSize));
+        }
+        if (y1 < m_rows - 1) {
+            bound = std::min(bound, m_minY + (y1 + 1) * m_cellSize - position.y);
+        }
+        if (bestId != kNoHead && bestDistance < bound) {
+            break;
+        }
+    }
+
+    if (distance) {
+        *distance = bestDistance;
+    }
+    return bestId;
+}
+
+} // namespace leach
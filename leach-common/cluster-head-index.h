@@ -0,0 +1,68 @@
+#ifndef LEACH_CLUSTER_HEAD_INDEX_H
+#define LEACH_CLUSTER_HEAD_INDEX_H
+
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace leach {
+
+// Uniform grid over the cluster-head positions of one round. Built once after
+// each election; nearest-head queries only visit the cells around the query
+// point instead of every head, which turns FormClusters from O(N*K) into
+// roughly O(N) for a well-spread field.
+class ClusterHeadIndex {
+public:
+    static constexpr uint32_t kNoHead = std::numeric_limits<uint32_t>::max();
+
+    ClusterHeadIndex();
+
+    // Rebuild the grid from parallel arrays of head IDs and positions
+    void Build(const std::vector<uint32_t>& headIds, const std::vector<ns3::Vector>& positions);
+    void Clear();
+
+    // Drop one head, e.g. when it fails mid-round; position must be the one it
+    // was indexed with. Only that head's cell is touched. Returns false if the
+    // head was not in the index.
+    bool Remove(uint32_t headId, const ns3::Vector& position);
+
+    // Add a head after Build, e.g. a promoted backup. Late heads are kept in a
+    // short side list that every query scans, so the grid stays untouched.
+    void Insert(uint32_t headId, const ns3::Vector& position);
+
+    // Nearest head to a point, or kNoHead if the index is empty. Ties go to the
+    // lowest head ID, matching a scan over clusters in ascending key order.
+    uint32_t FindNearest(const ns3::Vector& position, double* distance = nullptr) const;
+
+    // Heads currently indexed
+    std::size_t GetSize() const {
+        return m_live;
+    }
+
+private:
+    struct Entry {
+        uint32_t id;
+        double x;
+        double y;
+        double z;
+    };
+
+    uint32_t CellX(double x) const;
+    uint32_t CellY(double y) const;
+
+    double m_minX;
+    double m_minY;
+    double m_cellSize;
+    uint32_t m_cols;
+    uint32_t m_rows;
+    std::vector<uint32_t> m_cellStart; // CSR offsets into m_entries, one per cell plus end
+    std::vector<Entry> m_entries;      // Heads sorted by cell; removed ones keep their slot with id kNoHead
+    std::vector<Entry> m_late;         // Heads inserted after Build
+    std::size_t m_live;
+};
+
+} // namespace leach
+
+#endif // LEACH_CLUSTER_HEAD_INDEX_H
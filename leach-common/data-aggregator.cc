@@ -0,0 +1,43 @@
+#include "data-aggregator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace leach {
+
+void DataAggregator::SetCorrelation(double correlation) {
+    m_correlation = std::min(1.0, std::max(0.0, correlation));
+}
+
+void DataAggregator::Resize(uint32_t numNodes) {
+    m_payloads.assign(numNodes, 0);
+    m_bytes.assign(numNodes, 0);
+    m_largest.assign(numNodes, 0);
+    m_fusedPackets = 0;
+    m_collectedPayloads = 0;
+}
+
+void DataAggregator::Clear() {
+    std::fill(m_payloads.begin(), m_payloads.end(), 0);
+    std::fill(m_bytes.begin(), m_bytes.end(), 0);
+    std::fill(m_largest.begin(), m_largest.end(), 0);
+}
+
+uint32_t DataAggregator::Fuse(uint32_t headId) {
+    uint32_t payloads = m_payloads[headId];
+    if (payloads == 0) {
+        return 0;
+    }
+    // The largest reading is kept whole; the rest only add what is not redundant
+    double redundant = static_cast<double>(m_bytes[headId] - m_largest[headId]);
+    uint32_t fused = m_largest[headId] + static_cast<uint32_t>(std::ceil(redundant * (1.0 - m_correlation)));
+
+    m_fusedPackets++;
+    m_collectedPayloads += payloads;
+    m_payloads[headId] = 0;
+    m_bytes[headId] = 0;
+    m_largest[headId] = 0;
+    return fused;
+}
+
+} // namespace leach
@@ -0,0 +1,63 @@
+#ifndef LEACH_DATA_AGGREGATOR_H
+#define LEACH_DATA_AGGREGATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// Per-head buffer for the member readings of one TDMA frame. At the end of the
+// frame the head fuses everything it collected into a single uplink packet.
+// With correlation 1 the readings fuse perfectly into one reading (classic
+// LEACH aggregation); with correlation 0 they are simply concatenated.
+class DataAggregator {
+public:
+    DataAggregator() : m_correlation(1.0), m_fusedPackets(0), m_collectedPayloads(0) {}
+
+    // Correlation in [0, 1] between readings of the same cluster
+    void SetCorrelation(double correlation);
+
+    // Size the buffers for heads in [0, numNodes) and drop anything pending
+    void Resize(uint32_t numNodes);
+
+    // Drop every pending reading, e.g. when a round is torn down mid-frame
+    void Clear();
+
+    // Buffer one reading of the given size at a head
+    void Collect(uint32_t headId, uint32_t bytes) {
+        m_payloads[headId]++;
+        m_bytes[headId] += bytes;
+        if (bytes > m_largest[headId]) {
+            m_largest[headId] = bytes;
+        }
+    }
+
+    // Fuse a head's buffered readings and clear them; returns the uplink size
+    // in bytes, or 0 if the head collected nothing this frame
+    uint32_t Fuse(uint32_t headId);
+
+    uint32_t GetPendingPayloads(uint32_t headId) const {
+        return m_payloads[headId];
+    }
+
+    // Uplink packets produced and readings folded into them since Resize
+    uint64_t GetFusedPackets() const {
+        return m_fusedPackets;
+    }
+
+    uint64_t GetCollectedPayloads() const {
+        return m_collectedPayloads;
+    }
+
+private:
+    double m_correlation;
+    std::vector<uint32_t> m_payloads; // Readings buffered per head
+    std::vector<uint64_t> m_bytes;    // Their total size
+    std::vector<uint32_t> m_largest;  // Largest single reading; the fused packet never gets smaller
+    uint64_t m_fusedPackets;
+    uint64_t m_collectedPayloads;
+};
+
+} // namespace leach
+
+#endif // LEACH_DATA_AGGREGATOR_H
@@ -0,0 +1,94 @@
+#include "distributed.h"
+
+#ifdef NS3_MPI
+#include "ns3/global-value.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/string.h"
+
+#include <mpi.h>
+#endif
+
+namespace leach {
+
+#ifdef NS3_MPI
+
+namespace {
+
+bool g_enabled = false; // MPI is initialized and the distributed simulator selected
+
+double AllReduce(double value, MPI_Op op) {
+    if (!g_enabled) {
+        return value;
+    }
+    double result = value;
+    MPI_Allreduce(&value, &result, 1, MPI_DOUBLE, op, MPI_COMM_WORLD);
+    return result;
+}
+
+} // namespace
+
+bool EnableDistributed(int* argc, char*** argv) {
+    ns3::GlobalValue::Bind("SimulatorImplementationType", ns3::StringValue("ns3::DistributedSimulatorImpl"));
+    ns3::MpiInterface::Enable(argc, argv);
+    g_enabled = true;
+    return true;
+}
+
+void DisableDistributed() {
+    if (g_enabled) {
+        ns3::MpiInterface::Disable();
+        g_enabled = false;
+    }
+}
+
+uint32_t GetRank() {
+    return g_enabled ? ns3::MpiInterface::GetSystemId() : 0;
+}
+
+uint32_t GetRankCount() {
+    return g_enabled ? ns3::MpiInterface::GetSize() : 1;
+}
+
+double AllReduceSum(double value) {
+    return AllReduce(value, MPI_SUM);
+}
+
+double AllReduceMin(double value) {
+    return AllReduce(value, MPI_MIN);
+}
+
+double AllReduceMax(double value) {
+    return AllReduce(value, MPI_MAX);
+}
+
+#else
+
+bool EnableDistributed(int*, char***) {
+    return false;
+}
+
+void DisableDistributed() {}
+
+uint32_t GetRank() {
+    return 0;
+}
+
+uint32_t GetRankCount() {
+    return 1;
+}
+
+double AllReduceSum(double value) {
+    return value;
+}
+
+double AllReduceMin(double value) {
+    return value;
+}
+
+double AllReduceMax(double value) {
+    return value;
+}
+
+#endif // NS3_MPI
+
+} // namespace leach
@@ -0,0 +1,29 @@
+#ifndef LEACH_DISTRIBUTED_H
+#define LEACH_DISTRIBUTED_H
+
+#include <cstdint>
+
+namespace leach {
+
+// Thin layer over ns-3's MPI support for distributed runs. Without an
+// MPI-enabled ns-3 build (NS3_MPI undefined) there is a single rank, the
+// reductions return their argument and EnableDistributed reports failure.
+
+// Switch to the distributed simulator and initialize MPI; call after parsing
+// the command line and before creating any node. False if built without MPI.
+bool EnableDistributed(int* argc, char*** argv);
+
+// Finalize MPI; call after Simulator::Destroy
+void DisableDistributed();
+
+uint32_t GetRank();
+uint32_t GetRankCount();
+
+// Collectives over all ranks; every rank must call them in the same order
+double AllReduceSum(double value);
+double AllReduceMin(double value);
+double AllReduceMax(double value);
+
+} // namespace leach
+
+#endif // LEACH_DISTRIBUTED_H
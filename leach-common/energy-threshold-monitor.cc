@@ -0,0 +1,59 @@
+#include "energy-threshold-monitor.h"
+
+#include "ns3/abort.h"
+
+namespace leach {
+
+EnergyThresholdMonitor::EnergyThresholdMonitor(NodeStateTable& state, double stepFraction, double failureLevel)
+    : m_state(state), m_stepFraction(stepFraction), m_failureLevel(failureLevel) {}
+
+void EnergyThresholdMonitor::SetStepCallback(EnergyCallback callback) {
+    m_step = callback;
+}
+
+void EnergyThresholdMonitor::SetDepletionCallback(EnergyCallback callback) {
+    m_depletion = callback;
+}
+
+void EnergyThresholdMonitor::Subscribe(uint32_t nodeId, ns3::Ptr<ns3::energy::BasicEnergySource> source) {
+    NS_ABORT_MSG_UNLESS(nodeId < m_state.GetN(), "Node " << nodeId << " is outside the node state table");
+    double remaining = source->GetRemainingEnergy();
+    m_state.energy[nodeId] = remaining;
+    m_state.lastReportedEnergy[nodeId] = remaining;
+    source->TraceConnectWithoutContext("RemainingEnergy",
+                                       ns3::MakeBoundCallback(&EnergyThresholdMonitor::RemainingEnergyTrace,
+                                                              this, nodeId));
+}
+
+void EnergyThresholdMonitor::NotifyDepleted(uint32_t nodeId) {
+    if (!m_state.alive[nodeId]) {
+        return;
+    }
+    m_state.alive[nodeId] = 0;
+    if (!m_depletion.IsNull()) {
+        m_depletion(nodeId, m_state.energy[nodeId]);
+    }
+}
+
+void EnergyThresholdMonitor::RemainingEnergyTrace(EnergyThresholdMonitor* monitor, uint32_t nodeId,
+                                                  double, double newValue) {
+    monitor->Update(nodeId, newValue);
+}
+
+void EnergyThresholdMonitor::Update(uint32_t nodeId, double remaining) {
+    m_state.energy[nodeId] = remaining;
+
+    double& lastReported = m_state.lastReportedEnergy[nodeId];
+    if (remaining < lastReported && lastReported - remaining >= lastReported * m_stepFraction) {
+        lastReported = remaining;
+        if (!m_step.IsNull()) {
+            m_step(nodeId, remaining);
+        }
+    }
+
+    if (remaining <= m_failureLevel) {
+        NotifyDepleted(nodeId);
+    }
+}
+
+} // namespace leach
@@ -0,0 +1,55 @@
+#ifndef LEACH_ENERGY_THRESHOLD_MONITOR_H
+#define LEACH_ENERGY_THRESHOLD_MONITOR_H
+
+#include "node-state-table.h"
+
+#include "ns3/basic-energy-source.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+
+#include <cstdint>
+
+namespace leach {
+
+// Turns energy-source updates into threshold notifications. Instead of polling
+// every node on a timer, it subscribes to each BasicEnergySource's
+// RemainingEnergy trace, so work is done only when a node's energy actually
+// changes. The radio models keep their own depletion callback, which turns the
+// PHY off.
+//
+// A step notification fires whenever energy has dropped by at least
+// stepFraction of the last reported value; the depletion notification fires
+// once, when energy reaches failureLevel or NotifyDepleted is called.
+// Energy, last reported energy and liveness are kept in the shared state table.
+class EnergyThresholdMonitor {
+public:
+    // Receives the node ID and its remaining energy (J)
+    typedef ns3::Callback<void, uint32_t, double> EnergyCallback;
+
+    EnergyThresholdMonitor(NodeStateTable& state, double stepFraction, double failureLevel);
+
+    void SetStepCallback(EnergyCallback callback);
+    void SetDepletionCallback(EnergyCallback callback);
+
+    // Start watching a node's energy source; its current energy is the first baseline
+    void Subscribe(uint32_t nodeId, ns3::Ptr<ns3::energy::BasicEnergySource> source);
+
+    // Mark a node dead and report it, unless it already was
+    void NotifyDepleted(uint32_t nodeId);
+
+private:
+    static void RemainingEnergyTrace(EnergyThresholdMonitor* monitor, uint32_t nodeId,
+                                     double oldValue, double newValue);
+
+    void Update(uint32_t nodeId, double remaining);
+
+    NodeStateTable& m_state;
+    double m_stepFraction;
+    double m_failureLevel;
+    EnergyCallback m_step;
+    EnergyCallback m_depletion;
+};
+
+} // namespace leach
+
+#endif // LEACH_ENERGY_THRESHOLD_MONITOR_H
@@ -0,0 +1,91 @@
+#include "energy-trace-writer.h"
+
+#include <cstring>
+
+namespace leach {
+
+namespace {
+
+const char kMagic[8] = {'L', 'E', 'A', 'C', 'H', 'E', 'T', '1'};
+
+} // namespace
+
+EnergyTraceWriter::EnergyTraceWriter() : m_blockRecords(kDefaultBlockRecords), m_written(0) {}
+
+EnergyTraceWriter::~EnergyTraceWriter() {
+    Close();
+}
+
+bool EnergyTraceWriter::Open(const std::string& path, uint32_t blockRecords) {
+    Close();
+    m_blockRecords = blockRecords > 0 ? blockRecords : kDefaultBlockRecords;
+    m_written = 0;
+    m_time.reserve(m_blockRecords);
+    m_node.reserve(m_blockRecords);
+    m_energy.reserve(m_blockRecords);
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        return false;
+    }
+    m_file.write(kMagic, sizeof(kMagic));
+    return m_file.good();
+}
+
+void EnergyTraceWriter::Flush() {
+    if (!m_file.is_open() || m_time.empty()) {
+        return;
+    }
+    uint32_t count = static_cast<uint32_t>(m_time.size());
+    m_file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    m_file.write(reinterpret_cast<const char*>(m_time.data()), count * sizeof(double));
+    m_file.write(reinterpret_cast<const char*>(m_node.data()), count * sizeof(uint32_t));
+    m_file.write(reinterpret_cast<const char*>(m_energy.data()), count * sizeof(double));
+    m_written += count;
+    m_time.clear();
+    m_node.clear();
+    m_energy.clear();
+}
+
+void EnergyTraceWriter::Close() {
+    if (!m_file.is_open()) {
+        return;
+    }
+    Flush();
+    m_file.close();
+}
+
+bool EnergyTraceWriter::ExportText(const std::string& tracePath, std::ostream& out) {
+    std::ifstream in(tracePath, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+
+    std::vector<double> time;
+    std::vector<uint32_t> node;
+    std::vector<double> energy;
+    uint32_t count = 0;
+    while (in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        time.resize(count);
+        node.resize(count);
+        energy.resize(count);
+        if (!in.read(reinterpret_cast<char*>(time.data()), count * sizeof(double)) ||
+            !in.read(reinterpret_cast<char*>(node.data()), count * sizeof(uint32_t)) ||
+            !in.read(reinterpret_cast<char*>(energy.data()), count * sizeof(double))) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            out << "Time: " << time[i] << "s, Node " << node[i] << " Energy: " << energy[i] << "J\n";
+        }
+    }
+    out.flush();
+    return in.eof();
+}
+
+bool EnergyTraceWriter::ExportText(const std::string& tracePath, const std::string& textPath) {
+    std::ofstream out(textPath, std::ios::trunc);
+    return out.is_open() && ExportText(tracePath, out);
+}
+
+} // namespace leach
@@ -0,0 +1,75 @@
+#ifndef LEACH_ENERGY_TRACE_WRITER_H
+#define LEACH_ENERGY_TRACE_WRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+// Buffered writer for (time, node, energy) samples. The file stays open for the
+// whole run and records are collected in memory, then written as one columnar
+// block when the buffer fills:
+//
+//   header: "LEACHET1"
+//   block:  uint32 count | double time[count] | uint32 node[count] | double energy[count]
+//
+// Values are stored in host byte order. ExportText turns a trace back into the
+// "Time: <t>s, Node <n> Energy: <e>J" lines the text log used to contain.
+class EnergyTraceWriter {
+public:
+    static constexpr uint32_t kDefaultBlockRecords = 65536;
+
+    EnergyTraceWriter();
+    ~EnergyTraceWriter();
+
+    EnergyTraceWriter(const EnergyTraceWriter&) = delete;
+    EnergyTraceWriter& operator=(const EnergyTraceWriter&) = delete;
+
+    // Truncate path and start a new trace; returns false if it cannot be opened
+    bool Open(const std::string& path, uint32_t blockRecords = kDefaultBlockRecords);
+
+    bool IsOpen() const {
+        return m_file.is_open();
+    }
+
+    void Record(double time, uint32_t nodeId, double energy) {
+        if (!m_file.is_open()) {
+            return;
+        }
+        m_time.push_back(time);
+        m_node.push_back(nodeId);
+        m_energy.push_back(energy);
+        if (m_time.size() >= m_blockRecords) {
+            Flush();
+        }
+    }
+
+    // Write buffered records as one block
+    void Flush();
+
+    // Flush and close; safe to call more than once
+    void Close();
+
+    uint64_t GetRecordCount() const {
+        return m_written + m_time.size();
+    }
+
+    // Write a binary trace as text lines; returns false if it is missing or malformed
+    static bool ExportText(const std::string& tracePath, std::ostream& out);
+    static bool ExportText(const std::string& tracePath, const std::string& textPath);
+
+private:
+    std::ofstream m_file;
+    uint32_t m_blockRecords;
+    uint64_t m_written;
+    std::vector<double> m_time;
+    std::vector<uint32_t> m_node;
+    std::vector<double> m_energy;
+};
+
+} // namespace leach
+
+#endif // LEACH_ENERGY_TRACE_WRITER_H
@@ -0,0 +1,166 @@
+#include "event-recorder.h"
+
+#include "ns3/log.h"
+
+#include <cstring>
+
+NS_LOG_COMPONENT_DEFINE("LeachEvents");
+
+namespace leach {
+
+namespace {
+
+const char kMagic[8] = {'L', 'E', 'A', 'C', 'H', 'E', 'R', '1'};
+
+// Streams a record through Format, so NS_LOG_INFO only formats it when enabled
+struct RecordText {
+    const EventRecord& record;
+};
+
+std::ostream& operator<<(std::ostream& os, const RecordText& text) {
+    EventRecorder::Format(os, text.record);
+    return os;
+}
+
+int64_t Id(uint32_t id) {
+    return id == EventRecorder::kNone ? -1 : static_cast<int64_t>(id);
+}
+
+} // namespace
+
+EventRecorder& EventRecorder::Get() {
+    static EventRecorder recorder;
+    return recorder;
+}
+
+EventRecorder::EventRecorder() : m_enabled(false), m_wrapped(false), m_next(0), m_total(0) {}
+
+void EventRecorder::Enable(uint32_t capacity) {
+    m_ring.assign(capacity > 0 ? capacity : kDefaultCapacity, EventRecord());
+    m_next = 0;
+    m_total = 0;
+    m_wrapped = false;
+    m_enabled = true;
+}
+
+bool EventRecorder::Open(const std::string& path, uint32_t capacity) {
+    Close();
+    Enable(capacity);
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        return false;
+    }
+    m_file.write(kMagic, sizeof(kMagic));
+    return m_file.good();
+}
+
+void EventRecorder::Spill() {
+    uint32_t count = m_wrapped ? m_ring.size() : m_next;
+    if (count == 0) {
+        return;
+    }
+    m_file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    m_file.write(reinterpret_cast<const char*>(m_ring.data()), count * sizeof(EventRecord));
+    m_next = 0;
+    m_wrapped = false;
+}
+
+void EventRecorder::Close() {
+    if (!m_file.is_open()) {
+        return;
+    }
+    Spill();
+    m_file.close();
+}
+
+void EventRecorder::Dump(std::ostream& os) const {
+    std::size_t count = m_wrapped ? m_ring.size() : m_next;
+    std::size_t first = m_wrapped ? m_next : 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const EventRecord& record = m_ring[(first + i) % m_ring.size()];
+        os << record.time << "s ";
+        Format(os, record);
+        os << "\n";
+    }
+}
+
+void EventRecorder::Format(std::ostream& os, const EventRecord& record) {
+    switch (record.type) {
+    case RECORD_HEAD_ELECTED:
+        os << "Node " << record.node << " elected as cluster head with energy: " << record.value;
+        break;
+    case RECORD_MEMBER_JOINED:
+        os << "Node " << record.node << " joined cluster with head " << record.head;
+        break;
+    case RECORD_MEMBER_MOVED:
+        os << "Node " << record.node << " moved to cluster with head " << record.head;
+        break;
+    case RECORD_BACKUP_SELECTED:
+        os << "Cluster Head " << record.head << " has backup: " << Id(record.node);
+        break;
+    case RECORD_BACKUP_PROMOTED:
+        os << "Backup Node " << record.node << " took over the cluster of failed head " << record.head;
+        break;
+    case RECORD_HEAD_RELAY:
+        os << "Cluster Head " << record.node << " relays through " << record.head << " (" << record.value
+           << " hops to the base station)";
+        break;
+    case RECORD_MEMBER_REPORT:
+        os << "Node " << record.node << " sends data to Cluster Head " << record.head
+           << " with power level: " << record.value;
+        break;
+    case RECORD_HEAD_UPLINK:
+        os << "Cluster Head " << record.node << " sends " << record.value << " fused bytes towards node "
+           << record.head;
+        break;
+    case RECORD_LOW_ENERGY:
+        os << "Node " << record.node << " energy level: " << record.value << " J";
+        break;
+    case RECORD_NODE_FAILED:
+        os << "Node " << record.node << " has failed due to low energy.";
+        break;
+    default:
+        os << "Unknown event " << static_cast<uint32_t>(record.type) << " for node " << record.node;
+        break;
+    }
+}
+
+void EventRecorder::Log(RecordedEvent type, uint32_t node, uint32_t head, double value) {
+    EventRecord record;
+    record.time = 0.0;
+    record.value = value;
+    record.node = node;
+    record.head = head;
+    record.type = type;
+    NS_LOG_INFO(RecordText{record});
+}
+
+bool EventRecorder::ExportText(const std::string& logPath, std::ostream& out) {
+    std::ifstream in(logPath, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+
+    std::vector<EventRecord> records;
+    uint32_t count = 0;
+    while (in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        records.resize(count);
+        if (!in.read(reinterpret_cast<char*>(records.data()), count * sizeof(EventRecord))) {
+            return false;
+        }
+        for (const EventRecord& record : records) {
+            out << record.time << "s ";
+            Format(out, record);
+            out << "\n";
+        }
+    }
+    return in.eof();
+}
+
+bool EventRecorder::ExportText(const std::string& logPath, const std::string& textPath) {
+    std::ofstream out(textPath);
+    return out.is_open() && ExportText(logPath, out);
+}
+
+} // namespace leach
@@ -0,0 +1,127 @@
+#ifndef LEACH_EVENT_RECORDER_H
+#define LEACH_EVENT_RECORDER_H
+
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+// Protocol diagnostics kept by the event recorder
+enum RecordedEvent : uint8_t {
+    RECORD_HEAD_ELECTED = 0, // value: the head's energy (J)
+    RECORD_MEMBER_JOINED,    // head: the cluster joined at formation
+    RECORD_MEMBER_MOVED,     // head: the cluster a repair moved the node to
+    RECORD_BACKUP_SELECTED,  // node: the backup, or kNone; head: its cluster's head
+    RECORD_BACKUP_PROMOTED,  // node: the backup; head: the failed head
+    RECORD_HEAD_RELAY,       // node: a head; head: its relay; value: hops to the base station
+    RECORD_MEMBER_REPORT,    // node: a member; head: its head; value: power level
+    RECORD_HEAD_UPLINK,      // node: a head; head: its next hop; value: fused bytes
+    RECORD_LOW_ENERGY,       // value: remaining energy (J), when low or after a reportable drop
+    RECORD_NODE_FAILED,
+    RECORD_KIND_COUNT,
+};
+
+// One fixed-size record, stored and written as is
+struct EventRecord {
+    double time;  // Simulated seconds
+    double value;
+    uint32_t node;
+    uint32_t head;
+    uint8_t type; // RecordedEvent
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(EventRecord) == 32, "EventRecord is written raw");
+
+// Structured replacement for NS_LOG_INFO on the protocol's hot paths. While
+// enabled, Record stores a binary record in a preallocated ring buffer and
+// nothing is formatted until the records are dumped or exported, so verbose
+// diagnostics cost a few stores per event. Without a file the ring keeps the
+// most recent records; with one, every full ring is spilled to it as a block:
+//
+//   header: "LEACHER1"
+//   block:  uint32 count | EventRecord[count]
+//
+// While disabled, Record falls back to formatting the message through the
+// "LeachEvents" log component, so the old log lines stay available.
+class EventRecorder {
+public:
+    static constexpr uint32_t kNone = 0xffffffffu;
+    static constexpr uint32_t kDefaultCapacity = 65536;
+
+    static EventRecorder& Get();
+
+    // Preallocate the ring and start recording
+    void Enable(uint32_t capacity = kDefaultCapacity);
+
+    // Enable and spill every full ring to path; returns false if it cannot be opened
+    bool Open(const std::string& path, uint32_t capacity = kDefaultCapacity);
+
+    bool IsEnabled() const {
+        return m_enabled;
+    }
+
+    void Record(RecordedEvent type, uint32_t node, uint32_t head = kNone, double value = 0.0) {
+        if (!m_enabled) {
+            Log(type, node, head, value);
+            return;
+        }
+        EventRecord& record = m_ring[m_next];
+        record.time = ns3::Simulator::Now().GetSeconds();
+        record.value = value;
+        record.node = node;
+        record.head = head;
+        record.type = type;
+        m_total++;
+        if (++m_next == m_ring.size()) {
+            m_next = 0;
+            m_wrapped = true;
+            if (m_file.is_open()) {
+                Spill();
+            }
+        }
+    }
+
+    // Records taken since Enable, including overwritten ones
+    uint64_t GetRecordCount() const {
+        return m_total;
+    }
+
+    // Format the records still in the ring, oldest first
+    void Dump(std::ostream& os) const;
+
+    // Spill what the ring holds and close the file; safe to call more than once
+    void Close();
+
+    // One record as a log line, without its time
+    static void Format(std::ostream& os, const EventRecord& record);
+
+    // Write a spilled log as "<time>s <message>" lines; returns false if it is missing or malformed
+    static bool ExportText(const std::string& logPath, std::ostream& out);
+    static bool ExportText(const std::string& logPath, const std::string& textPath);
+
+private:
+    EventRecorder();
+
+    // Write the ring's records as one block and empty it
+    void Spill();
+
+    // The disabled path: format straight to the log component if it is enabled
+    static void Log(RecordedEvent type, uint32_t node, uint32_t head, double value);
+
+    bool m_enabled;
+    bool m_wrapped; // The ring has overwritten records since the last spill
+    std::size_t m_next;
+    uint64_t m_total;
+    std::vector<EventRecord> m_ring;
+    std::ofstream m_file;
+};
+
+} // namespace leach
+
+#endif // LEACH_EVENT_RECORDER_H
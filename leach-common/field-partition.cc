@@ -0,0 +1,47 @@
+#include "field-partition.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace leach {
+
+void FieldPartition::SetRanks(uint32_t rank, uint32_t ranks) {
+    m_rank = rank;
+    m_ranks = std::max(1u, ranks);
+    m_columns = 1;
+    for (uint32_t c = 1; c * c <= m_ranks; ++c) {
+        if (m_ranks % c == 0) {
+            m_columns = c;
+        }
+    }
+    m_rows = m_ranks / m_columns;
+}
+
+void FieldPartition::Assign(const NodeStateTable& state) {
+    uint32_t n = state.GetN();
+    m_owner.assign(n, 0);
+    if (m_ranks == 1 || n == 0) {
+        return;
+    }
+    double minX = *std::min_element(state.x.begin(), state.x.end());
+    double maxX = *std::max_element(state.x.begin(), state.x.end());
+    double minY = *std::min_element(state.y.begin(), state.y.end());
+    double maxY = *std::max_element(state.y.begin(), state.y.end());
+    double width = std::max(maxX - minX, 1e-9);
+    double height = std::max(maxY - minY, 1e-9);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t column = std::min(m_columns - 1, static_cast<uint32_t>((state.x[i] - minX) / width * m_columns));
+        uint32_t row = std::min(m_rows - 1, static_cast<uint32_t>((state.y[i] - minY) / height * m_rows));
+        m_owner[i] = row * m_columns + column;
+    }
+}
+
+uint32_t FieldPartition::GetLocalCount() const {
+    if (m_ranks == 1) {
+        return static_cast<uint32_t>(m_owner.size());
+    }
+    return static_cast<uint32_t>(std::count(m_owner.begin(), m_owner.end(), m_rank));
+}
+
+} // namespace leach
@@ -0,0 +1,54 @@
+#ifndef LEACH_FIELD_PARTITION_H
+#define LEACH_FIELD_PARTITION_H
+
+#include "node-state-table.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// Splits the sensor field into a grid of rectangular regions, one per rank,
+// over the bounding box of the node positions. Each node is owned by the rank
+// of the region it sits in; only owned nodes are elected, joined and charged
+// on that rank, so clusters never span two ranks.
+class FieldPartition {
+public:
+    FieldPartition() : m_rank(0), m_ranks(1), m_columns(1), m_rows(1) {}
+
+    // This process's rank among ranks; the grid is the most square
+    // columns x rows factorization of ranks
+    void SetRanks(uint32_t rank, uint32_t ranks);
+
+    // Assign every node in the table from its cached position
+    void Assign(const NodeStateTable& state);
+
+    bool IsLocal(uint32_t nodeId) const {
+        return m_ranks == 1 || m_owner[nodeId] == m_rank;
+    }
+
+    uint32_t GetOwner(uint32_t nodeId) const {
+        return m_ranks == 1 ? 0 : m_owner[nodeId];
+    }
+
+    uint32_t GetLocalCount() const;
+
+    uint32_t GetRank() const {
+        return m_rank;
+    }
+
+    uint32_t GetRankCount() const {
+        return m_ranks;
+    }
+
+private:
+    uint32_t m_rank;
+    uint32_t m_ranks;
+    uint32_t m_columns;
+    uint32_t m_rows;
+    std::vector<uint32_t> m_owner; // Owning rank per node
+};
+
+} // namespace leach
+
+#endif // LEACH_FIELD_PARTITION_H
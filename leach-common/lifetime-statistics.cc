@@ -0,0 +1,98 @@
+#include "lifetime-statistics.h"
+
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace leach {
+
+LifetimeStatistics::LifetimeStatistics() {
+    Reset(0, 0.0, 0.0);
+}
+
+void LifetimeStatistics::Reset(uint32_t numNodes, double initialEnergy, double stopFraction, uint32_t bins) {
+    m_nodes = numNodes;
+    m_initialEnergy = initialEnergy;
+    m_stopAt = stopFraction > 0.0 ? std::max(1u, static_cast<uint32_t>(std::ceil(std::min(1.0, stopFraction) * numNodes))) : 0;
+    m_dead = 0;
+    m_firstDeath = -1.0;
+    m_halfDeath = -1.0;
+    m_lastDeath = -1.0;
+    m_stopTime = -1.0;
+    m_rounds = 0;
+    m_headMean = 0.0;
+    m_headM2 = 0.0;
+    m_energyMean = initialEnergy;
+    m_energyVariance = 0.0;
+    m_histogram.assign(std::max(1u, bins), 0);
+    m_histogram.back() = numNodes; // Everyone starts full
+}
+
+void LifetimeStatistics::Resume(uint32_t deadNodes, double firstDeathTime) {
+    m_dead = std::min(deadNodes, m_nodes);
+    m_firstDeath = m_dead > 0 ? firstDeathTime : -1.0; // Later milestones before the checkpoint are unknown
+}
+
+void LifetimeStatistics::OnNodeDeath(double time) {
+    if (m_dead >= m_nodes) {
+        return;
+    }
+    m_dead++;
+    if (m_dead == 1) {
+        m_firstDeath = time;
+    }
+    if (m_dead == (m_nodes + 1) / 2) {
+        m_halfDeath = time;
+    }
+    if (m_dead == m_nodes) {
+        m_lastDeath = time;
+    }
+    if (m_stopAt > 0 && m_dead == m_stopAt) {
+        m_stopTime = time;
+        ns3::Simulator::Stop(); // After the current event
+    }
+}
+
+void LifetimeStatistics::OnRound(uint32_t heads) {
+    m_rounds++;
+    double delta = heads - m_headMean;
+    m_headMean += delta / m_rounds;
+    m_headM2 += delta * (heads - m_headMean);
+}
+
+void LifetimeStatistics::SampleEnergy(const std::vector<double>& energy) {
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    double mean = 0.0;
+    double m2 = 0.0;
+    uint32_t bins = m_histogram.size();
+    double binWidth = m_initialEnergy > 0.0 ? m_initialEnergy / bins : 1.0;
+    for (std::size_t i = 0; i < energy.size(); ++i) {
+        double delta = energy[i] - mean;
+        mean += delta / (i + 1);
+        m2 += delta * (energy[i] - mean);
+        uint32_t bin = std::min(bins - 1, static_cast<uint32_t>(std::max(0.0, energy[i]) / binWidth));
+        m_histogram[bin]++;
+    }
+    m_energyMean = mean;
+    m_energyVariance = energy.size() > 1 ? m2 / (energy.size() - 1) : 0.0;
+}
+
+void LifetimeStatistics::Print(std::ostream& os) const {
+    os << "Node deaths: " << m_dead << " of " << m_nodes << std::endl
+       << "  first: " << m_firstDeath << " s, half: " << m_halfDeath << " s, last: " << m_lastDeath << " s"
+       << std::endl;
+    if (m_stopTime >= 0.0) {
+        os << "  stopped at " << m_stopTime << " s after " << m_stopAt << " deaths" << std::endl;
+    }
+    os << "Cluster heads per round: " << m_headMean << " +/- " << std::sqrt(GetHeadVariance()) << " over "
+       << m_rounds << " rounds" << std::endl;
+    os << "Residual energy: mean " << m_energyMean << " J, variance " << m_energyVariance << " J^2" << std::endl
+       << "  histogram over [0, " << m_initialEnergy << "] J:";
+    for (uint32_t count : m_histogram) {
+        os << " " << count;
+    }
+    os << std::endl;
+}
+
+} // namespace leach
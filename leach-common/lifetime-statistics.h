@@ -0,0 +1,106 @@
+#ifndef LEACH_LIFETIME_STATISTICS_H
+#define LEACH_LIFETIME_STATISTICS_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace leach {
+
+// Network lifetime statistics collected while the run goes, in memory that
+// does not grow with simulated time: first, half and last node death, heads
+// per round (running mean and variance), and the residual energy of the last
+// sample as a fixed-bin histogram with its mean and variance. With a stop
+// fraction set, the death that reaches it stops the simulator, so a dead
+// network is not simulated to the end of --duration.
+class LifetimeStatistics {
+public:
+    static constexpr uint32_t kDefaultBins = 10;
+
+    LifetimeStatistics();
+
+    // Start a run over numNodes nodes of initialEnergy each. stopFraction in
+    // (0, 1] ends the run once that fraction of the nodes has died; 0 never does.
+    void Reset(uint32_t numNodes, double initialEnergy, double stopFraction, uint32_t bins = kDefaultBins);
+
+    // Carry over deaths that happened before a restored checkpoint
+    void Resume(uint32_t deadNodes, double firstDeathTime);
+
+    // A node died at time (s); report each node once
+    void OnNodeDeath(double time);
+
+    // Heads elected in a round
+    void OnRound(uint32_t heads);
+
+    // Residual energy of every node; replaces the previous sample
+    void SampleEnergy(const std::vector<double>& energy);
+
+    uint32_t GetDeadCount() const {
+        return m_dead;
+    }
+
+    // Milestone times (s), -1 until reached
+    double GetFirstDeath() const {
+        return m_firstDeath;
+    }
+
+    double GetHalfDeath() const {
+        return m_halfDeath;
+    }
+
+    double GetLastDeath() const {
+        return m_lastDeath;
+    }
+
+    // Time the stop criterion ended the run, or -1
+    double GetStopTime() const {
+        return m_stopTime;
+    }
+
+    uint64_t GetRounds() const {
+        return m_rounds;
+    }
+
+    double GetMeanHeads() const {
+        return m_headMean;
+    }
+
+    double GetHeadVariance() const {
+        return m_rounds > 1 ? m_headM2 / (m_rounds - 1) : 0.0;
+    }
+
+    double GetEnergyMean() const {
+        return m_energyMean;
+    }
+
+    double GetEnergyVariance() const {
+        return m_energyVariance;
+    }
+
+    // Node count per bin of [0, initialEnergy] in the last sample
+    const std::vector<uint32_t>& GetHistogram() const {
+        return m_histogram;
+    }
+
+    void Print(std::ostream& os) const;
+
+private:
+    uint32_t m_nodes;
+    double m_initialEnergy;
+    uint32_t m_stopAt;      // Deaths that end the run, 0 for never
+    uint32_t m_dead;
+    double m_firstDeath;
+    double m_halfDeath;
+    double m_lastDeath;
+    double m_stopTime;
+    uint64_t m_rounds;
+    double m_headMean;      // Welford running mean and sum of squared deviations
+    double m_headM2;
+    double m_energyMean;
+    double m_energyVariance;
+    std::vector<uint32_t> m_histogram;
+};
+
+} // namespace leach
+
+#endif // LEACH_LIFETIME_STATISTICS_H
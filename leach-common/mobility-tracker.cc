@@ -0,0 +1,124 @@
+#include "mobility-tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace leach {
+
+MobilityTracker::MobilityTracker()
+    : m_radius(0.0) {}
+
+void MobilityTracker::Resize(uint32_t n) {
+    m_x.assign(n, 0.0);
+    m_y.assign(n, 0.0);
+    m_z.assign(n, 0.0);
+    m_vx.assign(n, 0.0);
+    m_vy.assign(n, 0.0);
+    m_vz.assign(n, 0.0);
+    m_time.assign(n, 0.0);
+    m_anchorX.assign(n, 0.0);
+    m_anchorY.assign(n, 0.0);
+    m_anchorZ.assign(n, 0.0);
+    m_version.assign(n, 0);
+    m_heap.clear();
+}
+
+void MobilityTracker::SetRadius(double radius) {
+    m_radius = std::max(0.0, radius);
+}
+
+void MobilityTracker::SetCourse(uint32_t nodeId, const ns3::Vector& position, const ns3::Vector& velocity,
+                                double now) {
+    m_x[nodeId] = position.x;
+    m_y[nodeId] = position.y;
+    m_z[nodeId] = position.z;
+    m_vx[nodeId] = velocity.x;
+    m_vy[nodeId] = velocity.y;
+    m_vz[nodeId] = velocity.z;
+    m_time[nodeId] = now;
+    Push(nodeId, now); // The anchor stays; only its crossing time moves
+}
+
+ns3::Vector MobilityTracker::GetPosition(uint32_t nodeId, double now) const {
+    double dt = now - m_time[nodeId];
+    return ns3::Vector(m_x[nodeId] + m_vx[nodeId] * dt, m_y[nodeId] + m_vy[nodeId] * dt,
+                       m_z[nodeId] + m_vz[nodeId] * dt);
+}
+
+void MobilityTracker::Anchor(uint32_t nodeId, double now) {
+    ns3::Vector position = GetPosition(nodeId, now);
+    m_anchorX[nodeId] = position.x;
+    m_anchorY[nodeId] = position.y;
+    m_anchorZ[nodeId] = position.z;
+    Push(nodeId, now);
+}
+
+void MobilityTracker::AnchorAll(double now) {
+    m_heap.clear();
+    for (uint32_t i = 0; i < GetN(); ++i) {
+        ns3::Vector position = GetPosition(i, now);
+        m_anchorX[i] = position.x;
+        m_anchorY[i] = position.y;
+        m_anchorZ[i] = position.z;
+        m_version[i]++;
+        double time = CrossingTime(i, now);
+        if (time != std::numeric_limits<double>::infinity()) {
+            m_heap.push_back(Crossing{time, i, m_version[i]});
+        }
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Crossing>());
+}
+
+void MobilityTracker::TakeDue(double now, std::vector<uint32_t>& out) {
+    while (!m_heap.empty() && m_heap.front().time <= now) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Crossing>());
+        Crossing crossing = m_heap.back();
+        m_heap.pop_back();
+        if (crossing.version == m_version[crossing.node]) {
+            m_version[crossing.node]++; // Reported once; Anchor pushes the next crossing
+            out.push_back(crossing.node);
+        }
+    }
+}
+
+double MobilityTracker::CrossingTime(uint32_t nodeId, double now) const {
+    // Smallest s >= 0 with |d + v s| = radius, d the offset from the anchor now
+    ns3::Vector position = GetPosition(nodeId, now);
+    double dx = position.x - m_anchorX[nodeId];
+    double dy = position.y - m_anchorY[nodeId];
+    double dz = position.z - m_anchorZ[nodeId];
+    double c = dx * dx + dy * dy + dz * dz - m_radius * m_radius;
+    if (c >= 0.0) {
+        return now; // Already outside
+    }
+    double vv = m_vx[nodeId] * m_vx[nodeId] + m_vy[nodeId] * m_vy[nodeId] + m_vz[nodeId] * m_vz[nodeId];
+    if (vv == 0.0) {
+        return std::numeric_limits<double>::infinity(); // At rest until the next course change
+    }
+    double b = dx * m_vx[nodeId] + dy * m_vy[nodeId] + dz * m_vz[nodeId];
+    return now + (-b + std::sqrt(b * b - vv * c)) / vv;
+}
+
+void MobilityTracker::Push(uint32_t nodeId, double now) {
+    m_version[nodeId]++;
+    double time = CrossingTime(nodeId, now);
+    if (time == std::numeric_limits<double>::infinity()) {
+        return;
+    }
+    m_heap.push_back(Crossing{time, nodeId, m_version[nodeId]});
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Crossing>());
+    if (m_heap.size() > 2 * static_cast<std::size_t>(GetN()) + 64) {
+        Compact();
+    }
+}
+
+void MobilityTracker::Compact() {
+    m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(),
+                                [this](const Crossing& crossing) { return crossing.version != m_version[crossing.node]; }),
+                 m_heap.end());
+    std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Crossing>());
+}
+
+} // namespace leach
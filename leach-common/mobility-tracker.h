@@ -0,0 +1,83 @@
+#ifndef LEACH_MOBILITY_TRACKER_H
+#define LEACH_MOBILITY_TRACKER_H
+
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// Positions of moving sensors, kept from their CourseChange traces instead of
+// polling the mobility models. The ns-3 models that move nodes (random walk,
+// random waypoint, constant velocity, Gauss-Markov) only change velocity at a
+// course change, so a position at any later time is one multiply-add away.
+//
+// Each node also has an anchor, the position its cluster assignment was last
+// checked at, and the time it will stray the radius from that anchor at its
+// current velocity. The crossing times sit in a min-heap, so TakeDue only
+// visits the nodes whose time has come and costs O(1) while nobody crosses.
+class MobilityTracker {
+public:
+    MobilityTracker();
+
+    // Track nodes [0, n); everything starts at rest at the origin until SetCourse
+    void Resize(uint32_t n);
+
+    // How far a node may stray from its anchor before TakeDue reports it (m)
+    void SetRadius(double radius);
+
+    // A course change: the node is at position with velocity from time now on (s)
+    void SetCourse(uint32_t nodeId, const ns3::Vector& position, const ns3::Vector& velocity, double now);
+
+    ns3::Vector GetPosition(uint32_t nodeId, double now) const;
+
+    // Re-anchor a node at its position at now and schedule its next crossing
+    void Anchor(uint32_t nodeId, double now);
+
+    // Re-anchor every node, e.g. after a new round's formation; O(n)
+    void AnchorAll(double now);
+
+    // Append the nodes that have crossed by now to out. A reported node is not
+    // reported again until it has been re-anchored.
+    void TakeDue(double now, std::vector<uint32_t>& out);
+
+    uint32_t GetN() const {
+        return static_cast<uint32_t>(m_time.size());
+    }
+
+private:
+    struct Crossing {
+        double time;
+        uint32_t node;
+        uint32_t version; // Stale once the node's course or anchor changed after it was pushed
+
+        bool operator>(const Crossing& other) const {
+            return time > other.time;
+        }
+    };
+
+    double CrossingTime(uint32_t nodeId, double now) const;
+    void Push(uint32_t nodeId, double now);
+
+    // Drop stale crossings once they outnumber the live ones
+    void Compact();
+
+    double m_radius;
+    std::vector<double> m_x; // Position at the last course change
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_vx; // Velocity since then (m/s)
+    std::vector<double> m_vy;
+    std::vector<double> m_vz;
+    std::vector<double> m_time; // Time of the last course change (s)
+    std::vector<double> m_anchorX;
+    std::vector<double> m_anchorY;
+    std::vector<double> m_anchorZ;
+    std::vector<uint32_t> m_version;
+    std::vector<Crossing> m_heap; // std::push_heap min-heap on time; rebuilt by AnchorAll
+};
+
+} // namespace leach
+
+#endif // LEACH_MOBILITY_TRACKER_H
@@ -0,0 +1,36 @@
+#include "node-random-streams.h"
+
+#include "ns3/double.h"
+
+#include <algorithm>
+
+namespace leach {
+
+void NodeRandomStreams::Install(uint32_t numNodes) {
+    m_streams.clear();
+    m_streams.reserve(numNodes);
+    m_draws.assign(numNodes, 0);
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        ns3::Ptr<ns3::UniformRandomVariable> stream = ns3::CreateObject<ns3::UniformRandomVariable>();
+        stream->SetAttribute("Min", ns3::DoubleValue(0.0));
+        stream->SetAttribute("Max", ns3::DoubleValue(1.0));
+        m_streams.push_back(stream);
+    }
+}
+
+int64_t NodeRandomStreams::AssignStreams(int64_t stream) {
+    for (std::size_t i = 0; i < m_streams.size(); ++i) {
+        m_streams[i]->SetStream(stream + i);
+    }
+    std::fill(m_draws.begin(), m_draws.end(), 0);
+    return m_streams.size();
+}
+
+void NodeRandomStreams::Skip(uint32_t nodeId, uint64_t draws) {
+    for (uint64_t i = 0; i < draws; ++i) {
+        m_streams[nodeId]->GetValue();
+    }
+    m_draws[nodeId] += draws;
+}
+
+} // namespace leach
@@ -0,0 +1,50 @@
+#ifndef LEACH_NODE_RANDOM_STREAMS_H
+#define LEACH_NODE_RANDOM_STREAMS_H
+
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// One UniformRandomVariable per node, each pinned to its own RNG stream. Draws
+// for one node never perturb another node's sequence, so results depend only
+// on --seed/--run and the stream numbers, not on evaluation order, and no
+// state is shared between nodes.
+class NodeRandomStreams {
+public:
+    // Create one stream for each node in [0, numNodes)
+    void Install(uint32_t numNodes);
+
+    // Pin node i to stream number stream + i; returns the number of streams
+    // used, like the ns-3 helpers' AssignStreams
+    int64_t AssignStreams(int64_t stream);
+
+    // Uniform draw in [0, 1) from a node's stream
+    double Draw(uint32_t nodeId) {
+        m_draws[nodeId]++;
+        return m_streams[nodeId]->GetValue();
+    }
+
+    // Values drawn from a node's stream so far: its position for checkpoints
+    uint64_t GetDrawCount(uint32_t nodeId) const {
+        return m_draws[nodeId];
+    }
+
+    // Advance a node's stream by the given number of draws
+    void Skip(uint32_t nodeId, uint64_t draws);
+
+    uint32_t GetN() const {
+        return static_cast<uint32_t>(m_streams.size());
+    }
+
+private:
+    std::vector<ns3::Ptr<ns3::UniformRandomVariable>> m_streams;
+    std::vector<uint64_t> m_draws; // Values drawn per stream
+};
+
+} // namespace leach
+
+#endif // LEACH_NODE_RANDOM_STREAMS_H
@@ -0,0 +1,19 @@
+#include "node-registry.h"
+
+#include "ns3/abort.h"
+
+namespace leach {
+
+void NodeRegistry::Create(uint32_t numSensors) {
+    m_sensors = ns3::NodeContainer();
+    m_sensors.Create(numSensors);
+    m_nodes.assign(m_sensors.Begin(), m_sensors.End());
+    m_nodes.push_back(ns3::CreateObject<ns3::Node>());
+    for (uint32_t i = 0; i < m_nodes.size(); ++i) {
+        // The state table and the traces index by ns-3 node ID, so the two must agree
+        NS_ABORT_MSG_UNLESS(m_nodes[i]->GetId() == i, "Node " << i << " has ns-3 ID " << m_nodes[i]->GetId()
+                            << "; the network must be the first nodes created");
+    }
+}
+
+} // namespace leach
@@ -0,0 +1,58 @@
+#ifndef LEACH_NODE_REGISTRY_H
+#define LEACH_NODE_REGISTRY_H
+
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/ptr.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// The network's nodes, created once and left unchanged until the next
+// Create. The sensors have dense IDs in [0, GetN()), and the base station
+// gets the ID right after them. The engine, its clusters and every scheduled
+// event refer to nodes by these IDs. A Ptr<Node> only comes out for ns-3 APIs
+// that need one, and it is returned by reference, so no event copies a
+// container or touches a reference count.
+class NodeRegistry {
+public:
+    // Drop the previous network and create numSensors sensors, then the base station
+    void Create(uint32_t numSensors);
+
+    // Sensors, without the base station
+    uint32_t GetN() const {
+        return m_sensors.GetN();
+    }
+
+    uint32_t GetBaseStationId() const {
+        return GetN();
+    }
+
+    bool IsBaseStation(uint32_t nodeId) const {
+        return nodeId == GetBaseStationId();
+    }
+
+    // A sensor or the base station
+    const ns3::Ptr<ns3::Node>& Get(uint32_t nodeId) const {
+        return m_nodes[nodeId];
+    }
+
+    const ns3::Ptr<ns3::Node>& GetBaseStation() const {
+        return m_nodes.back();
+    }
+
+    // The sensors as one container for the ns-3 helpers
+    const ns3::NodeContainer& GetSensors() const {
+        return m_sensors;
+    }
+
+private:
+    ns3::NodeContainer m_sensors;
+    std::vector<ns3::Ptr<ns3::Node>> m_nodes; // Sensors, then the base station, by ID
+};
+
+} // namespace leach
+
+#endif // LEACH_NODE_REGISTRY_H
@@ -0,0 +1,101 @@
+#include "node-state-table.h"
+
+#include "ns3/abort.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node.h"
+
+#include <algorithm>
+
+namespace leach {
+
+void NodeStateTable::Resize(uint32_t n, double initialEnergy) {
+    energy.assign(n, initialEnergy);
+    lastReportedEnergy.assign(n, initialEnergy);
+    clusterHead.assign(n, kNone);
+    clusterIndex.assign(n, kNone);
+    memberIndex.assign(n, kNone);
+    role.assign(n, ROLE_UNASSIGNED);
+    headThisEpoch.assign(n, 0);
+    x.assign(n, 0.0);
+    y.assign(n, 0.0);
+    z.assign(n, 0.0);
+    alive.assign(n, 1);
+    linkDistance.assign(n, 0.0);
+    linkTxPower.assign(n, 0.0);
+}
+
+void NodeStateTable::SnapshotPositions(const ns3::NodeContainer& nodes) {
+    for (ns3::NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
+        uint32_t id = (*it)->GetId();
+        NS_ABORT_MSG_UNLESS(id < GetN(), "Node " << id << " is outside the node state table");
+        ns3::Vector position = (*it)->GetObject<ns3::MobilityModel>()->GetPosition();
+        x[id] = position.x;
+        y[id] = position.y;
+        z[id] = position.z;
+    }
+}
+
+void NodeStateTable::ResetClusters() {
+    std::fill(clusterHead.begin(), clusterHead.end(), kNone);
+    std::fill(clusterIndex.begin(), clusterIndex.end(), kNone);
+    std::fill(memberIndex.begin(), memberIndex.end(), kNone);
+    std::fill(role.begin(), role.end(), static_cast<uint8_t>(ROLE_UNASSIGNED));
+}
+
+void NodeStateTable::StartEpoch() {
+    std::fill(headThisEpoch.begin(), headThisEpoch.end(), static_cast<uint8_t>(0));
+}
+
+double NodeStateTable::TotalEnergy() const {
+    // Four independent partial sums so the reduction does not serialize on one register
+    const double* e = energy.data();
+    const std::size_t n = energy.size();
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += e[i];
+        s1 += e[i + 1];
+        s2 += e[i + 2];
+        s3 += e[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += e[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+double NodeStateTable::AverageEnergy() const {
+    return energy.empty() ? 0.0 : TotalEnergy() / energy.size();
+}
+
+uint32_t NodeStateTable::CollectFailures(double threshold, std::vector<uint32_t>& out) {
+    const std::size_t start = out.size();
+    const std::size_t n = energy.size();
+    out.resize(start + n);
+    const double* e = energy.data();
+    uint8_t* a = alive.data();
+    uint32_t* ids = out.data() + start;
+
+    // Branch-free compaction: always write the slot, advance only on a hit
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        uint8_t failed = a[i] & static_cast<uint8_t>(e[i] < threshold);
+        ids[found] = static_cast<uint32_t>(i);
+        found += failed;
+        a[i] &= static_cast<uint8_t>(failed ^ 1);
+    }
+    out.resize(start + found);
+    return static_cast<uint32_t>(found);
+}
+
+bool HasStaticTopology(const ns3::NodeContainer& nodes) {
+    for (ns3::NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it) {
+        if (!(*it)->GetObject<ns3::ConstantPositionMobilityModel>()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace leach
@@ -0,0 +1,99 @@
+#ifndef LEACH_NODE_STATE_TABLE_H
+#define LEACH_NODE_STATE_TABLE_H
+
+#include "ns3/node-container.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace leach {
+
+enum NodeRole : uint8_t {
+    ROLE_UNASSIGNED = 0,
+    ROLE_MEMBER = 1,
+    ROLE_CLUSTER_HEAD = 2,
+};
+
+// Per-node protocol state in structure-of-arrays form, indexed by node ID.
+// Sensor nodes are created first, so their IDs are dense in [0, GetN()).
+// Columns are public so hot paths can touch a single contiguous array; the
+// whole-table passes below are plain index loops the compiler can vectorize.
+struct NodeStateTable {
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    // Size the table for nodes [0, n) with full energy and no cluster
+    void Resize(uint32_t n, double initialEnergy);
+
+    // Cache every node's MobilityModel position in x/y/z
+    void SnapshotPositions(const ns3::NodeContainer& nodes);
+
+    // Forget all cluster assignments, keeping energy and liveness
+    void ResetClusters();
+
+    // Make every node eligible for election again at the start of a LEACH epoch
+    void StartEpoch();
+
+    void MarkClusterHead(uint32_t nodeId, uint32_t cluster) {
+        role[nodeId] = ROLE_CLUSTER_HEAD;
+        clusterHead[nodeId] = nodeId;
+        clusterIndex[nodeId] = cluster;
+    }
+
+    void AssignMember(uint32_t nodeId, uint32_t headId) {
+        role[nodeId] = ROLE_MEMBER;
+        clusterHead[nodeId] = headId;
+        clusterIndex[nodeId] = clusterIndex[headId];
+    }
+
+    // Take a node out of its cluster, e.g. when it fails mid-round
+    void Unassign(uint32_t nodeId) {
+        role[nodeId] = ROLE_UNASSIGNED;
+        clusterHead[nodeId] = kNone;
+        clusterIndex[nodeId] = kNone;
+        memberIndex[nodeId] = kNone;
+    }
+
+    // Cache the next-hop link of a node: its head for members, the base station for heads
+    void SetLink(uint32_t nodeId, double distance, double txPower) {
+        linkDistance[nodeId] = distance;
+        linkTxPower[nodeId] = txPower;
+    }
+
+    bool IsClusterHead(uint32_t nodeId) const {
+        return role[nodeId] == ROLE_CLUSTER_HEAD;
+    }
+
+    uint32_t GetN() const {
+        return static_cast<uint32_t>(energy.size());
+    }
+
+    double TotalEnergy() const;
+    double AverageEnergy() const;
+
+    // Append the IDs of live nodes whose energy is below threshold to out,
+    // clear their alive flag and return how many were found
+    uint32_t CollectFailures(double threshold, std::vector<uint32_t>& out);
+
+    std::vector<double> energy;              // Remaining energy (J)
+    std::vector<double> lastReportedEnergy;  // Energy at the last logged report (J)
+    std::vector<uint32_t> clusterHead;       // Head of the node's cluster (itself for heads), or kNone
+    std::vector<uint32_t> clusterIndex;      // Position of that cluster in the variant's cluster list
+    std::vector<uint32_t> memberIndex;       // Position in that cluster's member list, or kNone; kept by variants that repair clusters in place
+    std::vector<uint8_t> role;               // NodeRole
+    std::vector<uint8_t> headThisEpoch;      // 1 once the node has served as head in the current epoch
+    std::vector<double> x;                   // Cached position
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<uint8_t> alive;              // 0 once the node has failed or depleted
+    std::vector<double> linkDistance;        // Distance to the next hop this round (m)
+    std::vector<double> linkTxPower;         // DMS power level for that link
+};
+
+// True when every node uses ConstantPositionMobilityModel, so positions and
+// link distances can be cached for the whole run
+bool HasStaticTopology(const ns3::NodeContainer& nodes);
+
+} // namespace leach
+
+#endif // LEACH_NODE_STATE_TABLE_H
@@ -0,0 +1,87 @@
+#include "parameter-sweep.h"
+
+#include "ns3/command-line.h"
+#include "ns3/fatal-error.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace leach {
+
+namespace {
+
+// Knobs baked into the nodes, devices or positions built once for the sweep
+const char* const kFixedKnobs[] = {
+    "numNodes", "fieldSize", "topology", "hotspots", "hotspotSpread", "mobility", "nodeSpeed",
+    "abstractRadio", "energyModel", "radioModel", "sinkX", "sinkY",
+};
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+} // namespace
+
+void ParameterSweep::SetSpec(const std::string& spec) {
+    m_names.clear();
+    m_values.clear();
+    for (const std::string& axis : Split(spec, ';')) {
+        std::size_t equals = axis.find('=');
+        std::vector<std::string> values = equals == std::string::npos ? std::vector<std::string>()
+                                                                      : Split(axis.substr(equals + 1), ',');
+        if (equals == 0 || values.empty()) {
+            NS_FATAL_ERROR("Malformed sweep axis '" << axis << "'; expected name=value,value,...");
+        }
+        std::string name = axis.substr(0, equals);
+        if (std::find(std::begin(kFixedKnobs), std::end(kFixedKnobs), name) != std::end(kFixedKnobs)) {
+            NS_FATAL_ERROR("--" << name << " is fixed by the network built once for the sweep");
+        }
+        if (std::find(m_names.begin(), m_names.end(), name) != m_names.end()) {
+            NS_FATAL_ERROR("Sweep axis " << name << " appears twice");
+        }
+        m_names.push_back(name);
+        m_values.push_back(values);
+    }
+    if (m_names.empty()) {
+        NS_FATAL_ERROR("Empty sweep spec");
+    }
+}
+
+uint32_t ParameterSweep::GetPointCount() const {
+    uint32_t points = m_names.empty() ? 0 : 1;
+    for (const std::vector<std::string>& values : m_values) {
+        points *= values.size();
+    }
+    return points;
+}
+
+std::vector<std::string> ParameterSweep::GetPoint(uint32_t point) const {
+    std::vector<std::string> values(m_names.size());
+    for (std::size_t axis = m_names.size(); axis-- > 0;) {
+        values[axis] = m_values[axis][point % m_values[axis].size()];
+        point /= m_values[axis].size();
+    }
+    return values;
+}
+
+void ParameterSweep::Apply(uint32_t point, SimulationConfig& config) const {
+    std::vector<std::string> values = GetPoint(point);
+    std::vector<std::string> args;
+    args.push_back("sweep");
+    for (std::size_t axis = 0; axis < m_names.size(); ++axis) {
+        args.push_back("--" + m_names[axis] + "=" + values[axis]);
+    }
+    ns3::CommandLine cmd;
+    config.AddValues(cmd);
+    cmd.Parse(args);
+}
+
+} // namespace leach
@@ -0,0 +1,40 @@
+#ifndef LEACH_PARAMETER_SWEEP_H
+#define LEACH_PARAMETER_SWEEP_H
+
+#include "simulation-config.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+// Cartesian product of SimulationConfig values, e.g.
+// "clusterHeadProbability=0.05,0.1,0.2;initialEnergy=50,100" gives six points
+// with the last name varying fastest. Names are the command-line names, so any
+// knob can be swept except those fixed by the built topology and devices.
+class ParameterSweep {
+public:
+    // Fatal on a malformed spec or a knob that needs the network rebuilt
+    void SetSpec(const std::string& spec);
+
+    uint32_t GetPointCount() const;
+
+    const std::vector<std::string>& GetNames() const {
+        return m_names;
+    }
+
+    // The point's value for each name
+    std::vector<std::string> GetPoint(uint32_t point) const;
+
+    // Set the point's values on config, parsed as if given on the command line
+    void Apply(uint32_t point, SimulationConfig& config) const;
+
+private:
+    std::vector<std::string> m_names;
+    std::vector<std::vector<std::string>> m_values;
+};
+
+} // namespace leach
+
+#endif // LEACH_PARAMETER_SWEEP_H
@@ -0,0 +1,145 @@
+#include "profiler.h"
+
+#include "ns3/simulator.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <sys/resource.h>
+
+namespace leach {
+
+namespace {
+
+const char* const kEventNames[EVENT_KIND_COUNT] = {
+    "ClusterFrame",
+    "ElectClusterHeads",
+    "FormClusters",
+    "SetupClusterCommunications",
+    "ScheduleClusterFormation",
+    "LogEnergyLevels",
+    "CheckNodeFailure",
+    "ScheduleFailureCheck",
+    "BatchIntraClusterCommunication",
+    "BatchInterClusterCommunication",
+    "SetupTdmaSchedule",
+    "MemberSlot",
+    "HeadUplink",
+    "SetRadioSleep",
+    "DeliverReading",
+};
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+uint64_t Profiler::GetPeakRssBytes() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss; // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes elsewhere
+#endif
+}
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_enabled(false),
+      m_scheduled(),
+      m_executed(),
+      m_cancelled(0),
+      m_pending(0),
+      m_peakPending(0),
+      m_runWallSeconds(0.0),
+      m_simulatedSeconds(0.0),
+      m_totalEvents(0) {}
+
+Profiler::ScopedPhase::ScopedPhase(const char* name)
+    : m_name(name), m_start(std::chrono::steady_clock::now()) {}
+
+Profiler::ScopedPhase::~ScopedPhase() {
+    Profiler& profiler = Profiler::Get();
+    if (profiler.m_enabled) {
+        profiler.m_phases.emplace_back(m_name, SecondsSince(m_start));
+    }
+}
+
+void Profiler::RunSimulator() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ns3::Simulator::Run();
+    m_runWallSeconds = SecondsSince(start);
+    m_simulatedSeconds = ns3::Simulator::Now().GetSeconds();
+    m_totalEvents = ns3::Simulator::GetEventCount();
+    if (m_enabled) {
+        m_phases.emplace_back("Run", m_runWallSeconds);
+    }
+}
+
+void Profiler::Report(std::ostream& os) const {
+    os << "Wall time per phase:" << std::endl;
+    for (const auto& phase : m_phases) {
+        os << "  " << phase.first << ": " << phase.second << " s" << std::endl;
+    }
+    os << "Simulated " << m_simulatedSeconds << " s in " << m_runWallSeconds << " s wall ("
+       << (m_runWallSeconds > 0.0 ? m_simulatedSeconds / m_runWallSeconds : 0.0) << " sim-s/wall-s), "
+       << m_totalEvents << " events executed in total ("
+       << (m_runWallSeconds > 0.0 ? m_totalEvents / m_runWallSeconds : 0.0) << " events/s)" << std::endl;
+    os << "Peak RSS: " << GetPeakRssBytes() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    os << "Protocol events (scheduled / executed):" << std::endl;
+    for (int k = 0; k < EVENT_KIND_COUNT; ++k) {
+        if (m_scheduled[k] > 0 || m_executed[k] > 0) {
+            os << "  " << kEventNames[k] << ": " << m_scheduled[k] << " / " << m_executed[k] << std::endl;
+        }
+    }
+    os << "Cancelled protocol events: " << m_cancelled << std::endl;
+    os << "Peak pending protocol events: " << m_peakPending << std::endl;
+}
+
+void Profiler::WriteJson(std::ostream& os) const {
+    os << "{\n  \"phases\": {";
+    for (std::size_t i = 0; i < m_phases.size(); ++i) {
+        os << (i ? ", " : "") << "\"" << m_phases[i].first << "\": " << m_phases[i].second;
+    }
+    os << "},\n";
+    os << "  \"run\": {\"wallSeconds\": " << m_runWallSeconds
+       << ", \"simulatedSeconds\": " << m_simulatedSeconds
+       << ", \"simSecondsPerWallSecond\": " << (m_runWallSeconds > 0.0 ? m_simulatedSeconds / m_runWallSeconds : 0.0)
+       << ", \"executedEvents\": " << m_totalEvents
+       << ", \"eventsPerSecond\": " << (m_runWallSeconds > 0.0 ? m_totalEvents / m_runWallSeconds : 0.0)
+       << ", \"peakRssBytes\": " << GetPeakRssBytes() << "},\n";
+    os << "  \"protocolEvents\": {";
+    bool first = true;
+    for (int k = 0; k < EVENT_KIND_COUNT; ++k) {
+        if (m_scheduled[k] == 0 && m_executed[k] == 0) {
+            continue;
+        }
+        os << (first ? "" : ", ") << "\"" << kEventNames[k] << "\": {\"scheduled\": " << m_scheduled[k]
+           << ", \"executed\": " << m_executed[k] << "}";
+        first = false;
+    }
+    os << "},\n";
+    os << "  \"cancelledProtocolEvents\": " << m_cancelled << ",\n";
+    os << "  \"peakPendingProtocolEvents\": " << m_peakPending << "\n}\n";
+}
+
+void Profiler::Finish(const std::string& jsonPath) const {
+    if (!m_enabled) {
+        return;
+    }
+    Report(std::clog);
+    if (!jsonPath.empty()) {
+        std::ofstream json(jsonPath, std::ios::trunc);
+        WriteJson(json);
+    }
+}
+
+} // namespace leach
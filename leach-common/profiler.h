@@ -0,0 +1,143 @@
+#ifndef LEACH_PROFILER_H
+#define LEACH_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace leach {
+
+// Protocol callbacks counted by the profiler
+enum ProfiledEvent : uint8_t {
+    EVENT_CLUSTER_FRAME = 0,
+    EVENT_ELECT_CLUSTER_HEADS,
+    EVENT_FORM_CLUSTERS,
+    EVENT_SETUP_CLUSTER_COMMUNICATIONS,
+    EVENT_SCHEDULE_CLUSTER_FORMATION,
+    EVENT_LOG_ENERGY_LEVELS,
+    EVENT_CHECK_NODE_FAILURE,
+    EVENT_SCHEDULE_FAILURE_CHECK,
+    EVENT_BATCH_INTRA_CLUSTER,
+    EVENT_BATCH_INTER_CLUSTER,
+    EVENT_SETUP_TDMA_SCHEDULE,
+    EVENT_TDMA_SLOT,
+    EVENT_HEAD_UPLINK,
+    EVENT_RADIO_SLEEP,
+    EVENT_LINK_DELIVERY,
+    EVENT_KIND_COUNT,
+};
+
+// Opt-in wall-clock and event-count instrumentation for the basic-network
+// targets. Records wall time per setup phase and for Simulator::Run, how many
+// protocol events of each kind were scheduled, executed and cancelled, the
+// peak number of protocol events pending at once, the overall
+// simulated-seconds-per-wall-second and events-per-second rates and the peak
+// resident set size. Counting costs one branch while
+// disabled. Pending counts cover the protocol events scheduled through
+// Profiled(); ns-3's own Wi-Fi and energy events appear only in the total.
+class Profiler {
+public:
+    static Profiler& Get();
+
+    void Enable() {
+        m_enabled = true;
+    }
+
+    bool IsEnabled() const {
+        return m_enabled;
+    }
+
+    void OnScheduled(ProfiledEvent kind) {
+        if (m_enabled) {
+            m_scheduled[kind]++;
+            if (++m_pending > m_peakPending) {
+                m_peakPending = m_pending;
+            }
+        }
+    }
+
+    void OnExecuted(ProfiledEvent kind) {
+        if (m_enabled) {
+            m_executed[kind]++;
+            m_pending--;
+        }
+    }
+
+    void OnCancelled(uint64_t count) {
+        if (m_enabled) {
+            m_cancelled += count;
+            m_pending -= count;
+        }
+    }
+
+    // Times one setup phase from construction to destruction
+    class ScopedPhase {
+    public:
+        explicit ScopedPhase(const char* name);
+        ~ScopedPhase();
+
+    private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Simulator::Run, timed as the "Run" phase
+    void RunSimulator();
+
+    void Report(std::ostream& os) const;
+    void WriteJson(std::ostream& os) const;
+
+    // Wall seconds, simulated seconds and events of the last RunSimulator
+    double GetRunWallSeconds() const {
+        return m_runWallSeconds;
+    }
+
+    double GetSimulatedSeconds() const {
+        return m_simulatedSeconds;
+    }
+
+    uint64_t GetTotalEvents() const {
+        return m_totalEvents;
+    }
+
+    // Peak resident set size of the process so far, from getrusage
+    static uint64_t GetPeakRssBytes();
+
+    // Print the report to std::clog and, if jsonPath is not empty, write JSON there
+    void Finish(const std::string& jsonPath) const;
+
+private:
+    Profiler();
+
+    bool m_enabled;
+    uint64_t m_scheduled[EVENT_KIND_COUNT];
+    uint64_t m_executed[EVENT_KIND_COUNT];
+    uint64_t m_cancelled;
+    int64_t m_pending;
+    int64_t m_peakPending;
+    std::vector<std::pair<std::string, double>> m_phases; // Name and wall seconds, in order
+    double m_runWallSeconds;
+    double m_simulatedSeconds;
+    uint64_t m_totalEvents;
+};
+
+// Wrap f(args...) into a zero-argument event that is counted under kind when it
+// is scheduled and when it runs; f may be a member function with the object as
+// the first argument, e.g.
+//   Simulator::Schedule(Seconds(20.0), leach::Profiled(leach::EVENT_FORM_CLUSTERS, &FormClusters, nodes));
+template <typename FUNC, typename... Ts>
+auto Profiled(ProfiledEvent kind, FUNC f, Ts... args) {
+    Profiler::Get().OnScheduled(kind);
+    return [kind, f, args...]() {
+        Profiler::Get().OnExecuted(kind);
+        std::invoke(f, args...);
+    };
+}
+
+} // namespace leach
+
+#endif // LEACH_PROFILER_H
@@ -0,0 +1,816 @@
+#include "protocol-engine.h"
+
+#include "distributed.h"
+#include "event-recorder.h"
+#include "topology.h"
+
+#include "ns3/energy-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/log.h"
+#include "ns3/mobility-module.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-module.h"
+
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE("LeachEngine");
+
+namespace leach {
+
+namespace {
+
+// Below this many nodes a round's loops take less than waking the workers
+constexpr uint32_t kMinParallelNodes = 4096;
+
+} // namespace
+
+ProtocolEngine::ProtocolEngine(const SimulationConfig& config)
+    : m_config(config),
+      m_election(ELECTION_PROBABILITY),
+      m_energyModel(ENERGY_MANUAL),
+      m_powerPolicy(POWER_DMS),
+      m_radioModel(RADIO_DMS),
+      m_routing(ROUTING_DIRECT),
+      m_staticTopology(true),
+      m_round(0),
+      m_epochLength(1) {}
+
+void ProtocolEngine::ResolvePolicies() {
+    if (m_config.election == "probability") {
+        m_election = ELECTION_PROBABILITY;
+    } else if (m_config.election == "threshold") {
+        m_election = ELECTION_THRESHOLD;
+    } else if (m_config.election == "energy") {
+        m_election = ELECTION_ENERGY;
+    } else {
+        NS_FATAL_ERROR("Unknown election policy '" << m_config.election << "'; expected probability, threshold or energy");
+    }
+    double p = m_config.clusterHeadProbability;
+    m_epochLength = p > 0.0 ? std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(1.0 / p))) : 1;
+    m_round = 0;
+    if (m_config.energyModel == "manual") {
+        m_energyModel = ENERGY_MANUAL;
+    } else if (m_config.energyModel == "basic") {
+        m_energyModel = ENERGY_BASIC;
+    } else {
+        NS_FATAL_ERROR("Unknown energy model '" << m_config.energyModel << "'; expected manual or basic");
+    }
+    if (m_config.powerPolicy == "dms") {
+        m_powerPolicy = POWER_DMS;
+    } else if (m_config.powerPolicy == "priority") {
+        m_powerPolicy = POWER_PRIORITY;
+    } else {
+        NS_FATAL_ERROR("Unknown power policy '" << m_config.powerPolicy << "'; expected dms or priority");
+    }
+    if (m_config.radioModel == "dms") {
+        m_radioModel = RADIO_DMS;
+    } else if (m_config.radioModel == "firstorder") {
+        m_radioModel = RADIO_FIRST_ORDER;
+    } else {
+        NS_FATAL_ERROR("Unknown radio model '" << m_config.radioModel << "'; expected dms or firstorder");
+    }
+    m_radio.SetParameters(m_config.radioElectronics, m_config.radioFreeSpace, m_config.radioMultipath);
+    if (m_config.routing == "direct") {
+        m_routing = ROUTING_DIRECT;
+    } else if (m_config.routing == "relay") {
+        m_routing = ROUTING_RELAY;
+    } else {
+        NS_FATAL_ERROR("Unknown routing '" << m_config.routing << "'; expected direct or relay");
+    }
+    if (m_config.abstractRadio && m_energyModel == ENERGY_BASIC) {
+        NS_FATAL_ERROR("The abstract radio has no Wi-Fi device to drain; use --energyModel=manual");
+    }
+    m_pool.SetThreadCount(m_config.threads);
+    m_partition.SetRanks(GetRank(), GetRankCount());
+    if (m_partition.GetRankCount() > 1 && !m_config.abstractRadio) {
+        NS_FATAL_ERROR("Wi-Fi channels cannot span MPI ranks; distributed runs need --abstractRadio");
+    }
+    m_links.SetBands(m_config.linkBands);
+    m_links.SetDataRate(m_config.abstractDataRate);
+}
+
+void ProtocolEngine::CreateNodes() {
+    ResolvePolicies();
+
+    m_registry.Create(m_config.numNodes);
+    m_streams.Install(m_registry.GetN());
+    int64_t stream = m_streams.AssignStreams(0);
+    m_links.AssignStreams(stream);
+    m_clusters.clear();
+    m_nextHop.clear();
+    m_index.Clear();
+}
+
+void ProtocolEngine::ResetProtocolState() {
+    if (!m_staticTopology) {
+        NS_FATAL_ERROR("Mobile sensors would carry on from where the previous sweep point left them; sweeps need --mobility=static");
+    }
+    EnergyModelKind energyModel = m_energyModel;
+    RadioModelKind radioModel = m_radioModel;
+    ResolvePolicies();
+    if (m_energyModel != energyModel || m_radioModel != radioModel) {
+        NS_FATAL_ERROR("The energy and radio models are installed with the devices and cannot change between sweep points");
+    }
+    m_scheduler.BeginRound(); // Cancel traffic the previous point left pending
+
+    m_state.Resize(m_registry.GetN(), m_config.initialEnergy);
+    m_state.SnapshotPositions(m_registry.GetSensors());
+    if (m_energyModel == ENERGY_BASIC) {
+        for (uint32_t i = 0; i < m_sources.GetN(); ++i) {
+            ns3::Ptr<ns3::energy::BasicEnergySource> source =
+                ns3::DynamicCast<ns3::energy::BasicEnergySource>(m_sources.Get(i));
+            source->UpdateEnergySource(); // Settle the previous point's draw before refilling
+            source->SetInitialEnergy(m_config.initialEnergy); // Also resets the remaining energy
+            source->UpdateEnergySource(); // A depleted source sees the refill and turns its radio back on
+        }
+        SyncEnergy();
+        m_state.lastReportedEnergy = m_state.energy;
+    }
+
+    m_streams.AssignStreams(0); // Restart every stream from its first value
+    m_links.AssignStreams(m_streams.GetN());
+    ClearClusters();
+    m_index.Clear();
+}
+
+void ProtocolEngine::SetupNodes() {
+    if (m_config.abstractRadio) {
+        NS_LOG_INFO("Abstract radio: skipping the Wi-Fi and IP install on " << m_registry.GetN() << " nodes");
+        return;
+    }
+
+    ns3::WifiHelper wifi;
+    wifi.SetStandard(ns3::WIFI_STANDARD_80211b);
+
+    ns3::YansWifiChannelHelper wifiChannel = ns3::YansWifiChannelHelper::Default();
+    ns3::YansWifiPhyHelper wifiPhy;
+    wifiPhy.SetChannel(wifiChannel.Create());
+
+    ns3::WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac"); // Ad-hoc mode for direct communication
+
+    m_devices = wifi.Install(wifiPhy, wifiMac, m_registry.GetSensors());
+    m_baseStationDevice = wifi.Install(wifiPhy, wifiMac, m_registry.GetBaseStation()).Get(0);
+
+    ns3::InternetStackHelper stack;
+    stack.Install(m_registry.GetSensors());
+    stack.Install(m_registry.GetBaseStation());
+
+    ns3::Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    address.Assign(m_devices);
+    address.Assign(ns3::NetDeviceContainer(m_baseStationDevice));
+}
+
+void ProtocolEngine::SetupEnergyModel() {
+    m_state.Resize(m_registry.GetN(), m_config.initialEnergy);
+    if (m_energyModel != ENERGY_BASIC) {
+        return;
+    }
+
+    // The energy helpers moved between ns3 and ns3::energy across releases
+    using namespace ns3;
+    using namespace ns3::energy;
+
+    BasicEnergySourceHelper energySourceHelper;
+    energySourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(m_config.initialEnergy));
+    m_sources = energySourceHelper.Install(m_registry.GetSensors());
+
+    WifiRadioEnergyModelHelper radioEnergyHelper;
+    radioEnergyHelper.Set("TxCurrentA", DoubleValue(0.017)); // Transmit current
+    radioEnergyHelper.Set("RxCurrentA", DoubleValue(0.019)); // Receive current
+    if (m_radioModel == RADIO_FIRST_ORDER) {
+        radioEnergyHelper.SetTxCurrentModel("ns3::LinearWifiTxCurrentModel"); // Tx current grows with the per-link PHY power
+    }
+    m_radioModels = radioEnergyHelper.Install(m_devices, m_sources);
+
+    SyncEnergy();
+    m_state.lastReportedEnergy = m_state.energy;
+}
+
+void ProtocolEngine::SetMobility() {
+    const ns3::NodeContainer& sensors = m_registry.GetSensors();
+    InstallTopology(sensors, m_config);
+
+    ns3::Ptr<ns3::ConstantPositionMobilityModel> sink = ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+    sink->SetPosition(GetSinkPosition());
+    m_registry.GetBaseStation()->AggregateObject(sink);
+
+    m_state.SnapshotPositions(sensors);
+    m_staticTopology = HasStaticTopology(sensors);
+    m_partition.Assign(m_state);
+    if (!m_staticTopology) {
+        double now = ns3::Simulator::Now().GetSeconds();
+        m_mobility.Resize(m_registry.GetN());
+        for (uint32_t i = 0; i < m_registry.GetN(); ++i) {
+            ns3::Ptr<ns3::MobilityModel> model = m_registry.Get(i)->GetObject<ns3::MobilityModel>();
+            m_mobility.SetCourse(i, model->GetPosition(), model->GetVelocity(), now);
+            model->TraceConnectWithoutContext("CourseChange", ns3::MakeCallback(&ProtocolEngine::CourseChanged, this));
+        }
+    }
+    if (m_partition.GetRankCount() > 1) {
+        NS_LOG_INFO("Rank " << m_partition.GetRank() << " of " << m_partition.GetRankCount() << " owns "
+                    << m_partition.GetLocalCount() << " of " << m_registry.GetN() << " nodes");
+    }
+}
+
+void ProtocolEngine::CourseChanged(ns3::Ptr<const ns3::MobilityModel> model) {
+    uint32_t nodeId = model->GetObject<ns3::Node>()->GetId();
+    m_mobility.SetCourse(nodeId, model->GetPosition(), model->GetVelocity(), ns3::Simulator::Now().GetSeconds());
+}
+
+void ProtocolEngine::SnapshotMobilePositions() {
+    double now = ns3::Simulator::Now().GetSeconds();
+    for (uint32_t i = 0; i < m_mobility.GetN(); ++i) {
+        ns3::Vector position = m_mobility.GetPosition(i, now);
+        m_state.x[i] = position.x;
+        m_state.y[i] = position.y;
+        m_state.z[i] = position.z;
+    }
+}
+
+void ProtocolEngine::UpdateMobileNodes() {
+    if (m_staticTopology) {
+        return;
+    }
+    double now = ns3::Simulator::Now().GetSeconds();
+    m_crossed.clear();
+    m_mobility.TakeDue(now, m_crossed);
+    if (m_crossed.empty()) {
+        return;
+    }
+
+    // Crossed nodes get a new anchor and crossed members a re-check
+    m_recheck.clear();
+    m_recheckClusters.clear();
+    bool headMoved = false;
+    for (uint32_t nodeId : m_crossed) {
+        m_mobility.Anchor(nodeId, now);
+        ns3::Vector position = m_mobility.GetPosition(nodeId, now);
+        m_state.x[nodeId] = position.x;
+        m_state.y[nodeId] = position.y;
+        m_state.z[nodeId] = position.z;
+        if (m_state.IsClusterHead(nodeId)) {
+            headMoved = true;
+        } else if (m_state.role[nodeId] == ROLE_MEMBER) {
+            m_recheck.push_back(nodeId);
+        }
+    }
+
+    // A member m of head A can only prefer a moved head B if d(m, B) + h < d(m, A).
+    // Since d(m, A) < reach + h, that needs d(A, B) < 2 reach + h, so every other
+    // cluster stays as it is. B's own cluster always qualifies.
+    if (headMoved) {
+        BuildClusterHeadIndex(); // Heads are few; a rebuild keeps queries on the grid
+        for (uint32_t nodeId : m_crossed) {
+            if (!m_state.IsClusterHead(nodeId)) {
+                continue;
+            }
+            ns3::Vector moved = m_mobility.GetPosition(nodeId, now);
+            for (uint32_t c = 0; c < m_clusters.size(); ++c) {
+                uint32_t headId = m_clusters[c].clusterHead;
+                if (m_state.IsClusterHead(headId) &&
+                    ns3::CalculateDistance(moved, m_mobility.GetPosition(headId, now)) <
+                        2.0 * m_clusters[c].reach + m_config.hysteresis) {
+                    m_recheckClusters.push_back(c);
+                }
+            }
+        }
+        std::sort(m_recheckClusters.begin(), m_recheckClusters.end());
+        m_recheckClusters.erase(std::unique(m_recheckClusters.begin(), m_recheckClusters.end()),
+                                m_recheckClusters.end());
+        for (uint32_t c : m_recheckClusters) {
+            const std::vector<uint32_t>& members = m_clusters[c].members;
+            m_recheck.insert(m_recheck.end(), members.begin(), members.end());
+        }
+    }
+
+    for (uint32_t memberId : m_recheck) {
+        if (m_state.role[memberId] != ROLE_MEMBER) {
+            continue;
+        }
+        ns3::Vector position = m_mobility.GetPosition(memberId, now);
+        uint32_t headId = m_state.clusterHead[memberId];
+        double distance = ns3::CalculateDistance(position, m_mobility.GetPosition(headId, now));
+        uint32_t nearest = m_index.FindNearest(position);
+        if (nearest != ClusterHeadIndex::kNoHead && nearest != headId) {
+            double nearestDistance = ns3::CalculateDistance(position, m_mobility.GetPosition(nearest, now));
+            if (nearestDistance + m_config.hysteresis < distance) {
+                RemoveMember(memberId);
+                AddMember(memberId, nearest, nearestDistance);
+                EventRecorder::Get().Record(RECORD_MEMBER_MOVED, memberId, nearest);
+                continue;
+            }
+        }
+        m_state.SetLink(memberId, distance, TransmissionPower(distance));
+        double& reach = m_clusters[m_state.clusterIndex[memberId]].reach;
+        reach = std::max(reach, distance);
+    }
+    if (headMoved) {
+        SetupUplinks(); // Uplink lengths and relay costs moved with the heads
+    }
+}
+
+void ProtocolEngine::ClearClusters() {
+    m_clusters.clear();
+    m_nextHop.clear();
+    m_state.ResetClusters();
+}
+
+template <class Election>
+bool ProtocolEngine::Elects(const ElectionContext& ctx, uint32_t nodeId) {
+    // Every node draws each round so its stream stays aligned regardless of energy or rank
+    // Draws are in [0, 1), so T(n) = 0 never elects and T(n) = 1 always does
+    return m_streams.Draw(nodeId) < Election::Threshold(ctx, m_state, nodeId) && m_state.alive[nodeId] &&
+           m_state.energy[nodeId] > m_config.minHeadEnergy && m_partition.IsLocal(nodeId);
+}
+
+void ProtocolEngine::AddClusterHead(uint32_t nodeId) {
+    Cluster newCluster;
+    newCluster.clusterHead = nodeId;
+    m_clusters.push_back(newCluster);
+    m_state.MarkClusterHead(nodeId, m_clusters.size() - 1);
+    m_state.headThisEpoch[nodeId] = 1;
+    EventRecorder::Get().Record(RECORD_HEAD_ELECTED, nodeId, nodeId, m_state.energy[nodeId]);
+}
+
+template <class Election>
+void ProtocolEngine::ElectWith() {
+    ElectionContext ctx;
+    ctx.p = m_config.clusterHeadProbability;
+    ctx.roundInEpoch = m_round % m_epochLength;
+    ctx.averageEnergy = Election::kUsesAverageEnergy ? GlobalAverageEnergy() : 0.0;
+    uint32_t n = m_registry.GetN();
+    if (!UseWorkers(n)) {
+        for (uint32_t nodeId = 0; nodeId < n; ++nodeId) {
+            if (Elects<Election>(ctx, nodeId)) {
+                AddClusterHead(nodeId);
+            }
+        }
+        return;
+    }
+
+    // A node's threshold reads only its own row, which nothing writes until the merge
+    m_electedChunks.resize(m_pool.GetThreadCount());
+    uint32_t chunks = m_pool.Run(n, [this, &ctx](uint32_t chunk, uint32_t begin, uint32_t end) {
+        std::vector<uint32_t>& elected = m_electedChunks[chunk];
+        elected.clear();
+        for (uint32_t nodeId = begin; nodeId < end; ++nodeId) {
+            if (Elects<Election>(ctx, nodeId)) {
+                elected.push_back(nodeId);
+            }
+        }
+    });
+    for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+        for (uint32_t nodeId : m_electedChunks[chunk]) {
+            AddClusterHead(nodeId);
+        }
+    }
+}
+
+uint32_t ProtocolEngine::ElectClusterHeads() {
+    m_scheduler.BeginRound(); // Retire the previous round's traffic chains
+    ClearClusters();
+    if (!m_staticTopology) {
+        SnapshotMobilePositions(); // Nodes may have moved since the last round
+    }
+    SyncEnergy();
+
+    NS_LOG_INFO("Starting a new round of cluster head elections...");
+    if (m_round % m_epochLength == 0) {
+        m_state.StartEpoch();
+    }
+    switch (m_election) {
+    case ELECTION_PROBABILITY:
+        ElectWith<ProbabilityElection>();
+        break;
+    case ELECTION_THRESHOLD:
+        ElectWith<ThresholdElection>();
+        break;
+    case ELECTION_ENERGY:
+        ElectWith<EnergyWeightedElection>();
+        break;
+    }
+    m_round++;
+    if (m_clusters.empty()) {
+        NS_LOG_INFO("No cluster heads elected this round.");
+    }
+    BuildClusterHeadIndex();
+    return m_clusters.size();
+}
+
+void ProtocolEngine::BuildClusterHeadIndex() {
+    std::vector<uint32_t> headIds;
+    std::vector<ns3::Vector> headPositions;
+    headIds.reserve(m_clusters.size());
+    headPositions.reserve(m_clusters.size());
+    for (const Cluster& cluster : m_clusters) {
+        uint32_t headId = cluster.clusterHead;
+        if (m_state.IsClusterHead(headId)) { // Repaired clusters keep their slot but have no head
+            headIds.push_back(headId);
+            headPositions.push_back(GetPosition(headId));
+        }
+    }
+    m_index.Build(headIds, headPositions);
+}
+
+template <class Power>
+void ProtocolEngine::AddMemberWith(uint32_t nodeId, uint32_t headId, double distance) {
+    Cluster& cluster = m_clusters[m_state.clusterIndex[headId]];
+    m_state.AssignMember(nodeId, headId);
+    m_state.memberIndex[nodeId] = cluster.members.size();
+    cluster.members.push_back(nodeId);
+    cluster.reach = std::max(cluster.reach, distance);
+    m_state.SetLink(nodeId, distance, Power::Power(distance, false));
+}
+
+bool ProtocolEngine::FindHead(uint32_t nodeId, uint32_t& headId, double& distance) const {
+    // Only live non-cluster-head nodes join; the index holds this rank's heads only
+    if (m_state.IsClusterHead(nodeId) || !m_state.alive[nodeId] || !m_partition.IsLocal(nodeId)) {
+        return false;
+    }
+    headId = m_index.FindNearest(GetPosition(nodeId), &distance);
+    return headId != ClusterHeadIndex::kNoHead;
+}
+
+template <class Power>
+void ProtocolEngine::FormWith() {
+    uint32_t n = m_registry.GetN();
+    if (!UseWorkers(n)) {
+        for (uint32_t nodeId = 0; nodeId < n; ++nodeId) {
+            uint32_t headId = 0;
+            double distance = 0.0;
+            if (FindHead(nodeId, headId, distance)) {
+                AddMemberWith<Power>(nodeId, headId, distance);
+                EventRecorder::Get().Record(RECORD_MEMBER_JOINED, nodeId, headId);
+            }
+        }
+        return;
+    }
+
+    // Queries only read the index and the positions; members join in ID order afterwards
+    m_joinChunks.resize(m_pool.GetThreadCount());
+    uint32_t chunks = m_pool.Run(n, [this](uint32_t chunk, uint32_t begin, uint32_t end) {
+        std::vector<Join>& joins = m_joinChunks[chunk];
+        joins.clear();
+        for (uint32_t nodeId = begin; nodeId < end; ++nodeId) {
+            Join join{nodeId, 0, 0.0};
+            if (FindHead(nodeId, join.head, join.distance)) {
+                joins.push_back(join);
+            }
+        }
+    });
+    for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+        for (const Join& join : m_joinChunks[chunk]) {
+            AddMemberWith<Power>(join.node, join.head, join.distance);
+            EventRecorder::Get().Record(RECORD_MEMBER_JOINED, join.node, join.head);
+        }
+    }
+}
+
+bool ProtocolEngine::UseWorkers(uint32_t n) const {
+    return m_pool.GetThreadCount() > 1 && n >= kMinParallelNodes;
+}
+
+void ProtocolEngine::FormClusters() {
+    switch (m_powerPolicy) {
+    case POWER_DMS:
+        FormWith<DmsPower>();
+        break;
+    case POWER_PRIORITY:
+        FormWith<PriorityPower>();
+        break;
+    }
+
+    // Backups can only be chosen once the members are known
+    if (m_config.backupHeads) {
+        for (uint32_t c = 0; c < m_clusters.size(); ++c) {
+            SelectBackupHead(c);
+        }
+    }
+
+    // Every node joined its nearest head from here. A member is re-checked when
+    // it, its head or a head that may now be nearer strays hysteresis / 4 from
+    // its anchor. Until then none of the three moved that far, so no distance
+    // the last check compared can have drifted by hysteresis in total.
+    if (!m_staticTopology) {
+        m_mobility.SetRadius(m_config.hysteresis / 4.0);
+        m_mobility.AnchorAll(ns3::Simulator::Now().GetSeconds());
+    }
+}
+
+void ProtocolEngine::AddMember(uint32_t nodeId, uint32_t headId, double distance) {
+    switch (m_powerPolicy) {
+    case POWER_DMS:
+        AddMemberWith<DmsPower>(nodeId, headId, distance);
+        break;
+    case POWER_PRIORITY:
+        AddMemberWith<PriorityPower>(nodeId, headId, distance);
+        break;
+    }
+}
+
+void ProtocolEngine::RemoveMember(uint32_t nodeId) {
+    uint32_t cluster = m_state.clusterIndex[nodeId];
+    std::vector<uint32_t>& members = m_clusters[cluster].members;
+    uint32_t position = m_state.memberIndex[nodeId];
+    uint32_t last = members.back();
+    members[position] = last;
+    m_state.memberIndex[last] = position;
+    members.pop_back();
+    m_state.Unassign(nodeId);
+
+    if (m_clusters[cluster].backupHead == nodeId) {
+        SelectBackupHead(cluster); // The successor itself is gone
+    }
+}
+
+void ProtocolEngine::RepairCluster(uint32_t headId) {
+    Cluster& cluster = m_clusters[m_state.clusterIndex[headId]];
+    cluster.backupHead = NodeStateTable::kNone;
+    m_index.Remove(headId, GetPosition(headId));
+    m_state.Unassign(headId);
+
+    std::vector<uint32_t> orphans;
+    orphans.swap(cluster.members);
+    for (uint32_t memberId : orphans) {
+        m_state.Unassign(memberId);
+        double distance = 0.0;
+        uint32_t newHead = m_index.FindNearest(GetPosition(memberId), &distance);
+        if (newHead != ClusterHeadIndex::kNoHead) {
+            AddMember(memberId, newHead, distance);
+            EventRecorder::Get().Record(RECORD_MEMBER_MOVED, memberId, newHead);
+        }
+    }
+    SetupUplinks(); // Heads that relayed through the failed one need a new path
+}
+
+void ProtocolEngine::SelectBackupHead(uint32_t cluster) {
+    uint32_t backup = NodeStateTable::kNone;
+    double maxEnergy = 0.0;
+    for (uint32_t memberId : m_clusters[cluster].members) {
+        if (m_state.alive[memberId] && m_state.energy[memberId] > maxEnergy) {
+            maxEnergy = m_state.energy[memberId];
+            backup = memberId;
+        }
+    }
+    m_clusters[cluster].backupHead = backup;
+    EventRecorder::Get().Record(RECORD_BACKUP_SELECTED, backup, m_clusters[cluster].clusterHead);
+}
+
+bool ProtocolEngine::PromoteBackupHead(uint32_t headId) {
+    uint32_t cluster = m_state.clusterIndex[headId];
+    Cluster& entry = m_clusters[cluster];
+    uint32_t backupId = entry.backupHead;
+    if (backupId == NodeStateTable::kNone || !m_state.alive[backupId] || m_state.clusterIndex[backupId] != cluster) {
+        return false;
+    }
+    entry.backupHead = NodeStateTable::kNone;
+    RemoveMember(backupId);
+
+    m_index.Remove(headId, GetPosition(headId));
+    m_state.Unassign(headId);
+
+    ns3::Vector headPosition = GetPosition(backupId);
+    entry.clusterHead = backupId;
+    m_state.MarkClusterHead(backupId, cluster);
+    m_state.headThisEpoch[backupId] = 1; // Serving the rest of the round counts as its turn
+    m_index.Insert(backupId, headPosition);
+    entry.reach = 0.0;
+    for (uint32_t memberId : entry.members) {
+        m_state.AssignMember(memberId, backupId);
+        double distance = ns3::CalculateDistance(GetPosition(memberId), headPosition);
+        m_state.SetLink(memberId, distance, TransmissionPower(distance));
+        entry.reach = std::max(entry.reach, distance);
+    }
+
+    EventRecorder::Get().Record(RECORD_BACKUP_PROMOTED, backupId, headId);
+    SelectBackupHead(cluster);
+    SetupUplinks(); // The new head sits elsewhere; other heads may relay through it
+    return true;
+}
+
+void ProtocolEngine::SaveCheckpoint(Checkpoint& checkpoint) const {
+    uint32_t n = m_state.GetN();
+    checkpoint.round = m_round;
+    checkpoint.seed = ns3::RngSeedManager::GetSeed();
+    checkpoint.run = ns3::RngSeedManager::GetRun();
+    checkpoint.linkDraws = m_links.GetDrawCount();
+    checkpoint.energy = m_state.energy;
+    checkpoint.alive = m_state.alive;
+    checkpoint.headThisEpoch = m_state.headThisEpoch;
+    checkpoint.clusterHead = m_state.clusterHead;
+    checkpoint.streamDraws.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        checkpoint.streamDraws[i] = m_streams.GetDrawCount(i);
+    }
+    checkpoint.heads.clear();
+    checkpoint.backups.clear();
+    for (const Cluster& cluster : m_clusters) {
+        checkpoint.heads.push_back(cluster.clusterHead);
+        checkpoint.backups.push_back(cluster.backupHead);
+    }
+}
+
+void ProtocolEngine::RestoreCheckpoint(const Checkpoint& checkpoint) {
+    uint32_t n = m_state.GetN();
+    if (checkpoint.energy.size() != n) {
+        NS_FATAL_ERROR("Checkpoint has " << checkpoint.energy.size() << " nodes, this run " << n);
+    }
+    if (checkpoint.seed != ns3::RngSeedManager::GetSeed() || checkpoint.run != ns3::RngSeedManager::GetRun()) {
+        NS_FATAL_ERROR("Checkpoint was taken with seed " << checkpoint.seed << " run " << checkpoint.run
+                       << "; the topology would differ");
+    }
+    if (m_energyModel != ENERGY_MANUAL) {
+        NS_FATAL_ERROR("Checkpoints restore the manual energy model only; energy sources cannot be refilled");
+    }
+    if (!m_staticTopology) {
+        NS_FATAL_ERROR("Checkpoints do not record trajectories; mobile runs cannot be restored");
+    }
+
+    m_round = checkpoint.round;
+    m_state.energy = checkpoint.energy;
+    m_state.lastReportedEnergy = checkpoint.energy;
+    m_state.alive = checkpoint.alive;
+    m_state.headThisEpoch = checkpoint.headThisEpoch;
+    for (uint32_t i = 0; i < n; ++i) {
+        m_streams.Skip(i, checkpoint.streamDraws[i] - m_streams.GetDrawCount(i));
+    }
+    m_links.Skip(checkpoint.linkDraws - m_links.GetDrawCount());
+
+    // Heads first so members can find their cluster; members rejoin in ID order, as formation adds them
+    ClearClusters();
+    for (uint32_t headId : checkpoint.heads) {
+        Cluster cluster;
+        cluster.clusterHead = headId;
+        m_clusters.push_back(cluster);
+        m_state.MarkClusterHead(headId, m_clusters.size() - 1);
+    }
+    BuildClusterHeadIndex();
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t headId = checkpoint.clusterHead[i];
+        if (headId != NodeStateTable::kNone && headId != i) {
+            AddMember(i, headId, ns3::CalculateDistance(GetPosition(i), GetPosition(headId)));
+        }
+    }
+    for (uint32_t c = 0; c < m_clusters.size(); ++c) {
+        m_clusters[c].backupHead = checkpoint.backups[c];
+    }
+    SetupUplinks();
+    NS_LOG_INFO("Restored round " << m_round << " at " << checkpoint.time << " s with " << m_clusters.size()
+                << " clusters");
+}
+
+double ProtocolEngine::UpdateEnergy(uint32_t nodeId, double energyUsed) {
+    if (nodeId >= m_state.GetN()) {
+        return 0.0;
+    }
+    if (m_energyModel == ENERGY_BASIC) {
+        return BasicEnergy::Charge(m_state.energy[nodeId], energyUsed);
+    }
+    return ManualEnergy::Charge(m_state.energy[nodeId], energyUsed);
+}
+
+void ProtocolEngine::SyncEnergy() {
+    for (uint32_t i = 0; i < m_sources.GetN(); i++) {
+        m_state.energy[i] = m_sources.Get(i)->GetRemainingEnergy();
+    }
+}
+
+double ProtocolEngine::GlobalAverageEnergy() const {
+    if (m_partition.GetRankCount() == 1) {
+        return m_state.AverageEnergy();
+    }
+    double localEnergy = 0.0;
+    double localNodes = 0.0;
+    for (uint32_t i = 0; i < m_state.GetN(); ++i) {
+        if (m_partition.IsLocal(i)) {
+            localEnergy += m_state.energy[i];
+            localNodes += 1.0;
+        }
+    }
+    double nodes = AllReduceSum(localNodes);
+    double energy = AllReduceSum(localEnergy);
+    return nodes > 0.0 ? energy / nodes : 0.0;
+}
+
+double ProtocolEngine::TransmissionPower(double distance, bool highPriority) const {
+    if (m_powerPolicy == POWER_PRIORITY) {
+        return PriorityPower::Power(distance, highPriority);
+    }
+    return DmsPower::Power(distance, highPriority);
+}
+
+double ProtocolEngine::LinkDistance(uint32_t nodeId, uint32_t nextHopId) const {
+    if (m_staticTopology) {
+        return m_state.linkDistance[nodeId];
+    }
+    return MobileDistance(nodeId, nextHopId);
+}
+
+double ProtocolEngine::TransmitEnergy(uint32_t nodeId, uint32_t nextHopId, uint32_t bytes, double dmsCost) const {
+    if (m_radioModel == RADIO_FIRST_ORDER) {
+        return m_radio.TxEnergy(8ULL * bytes, LinkDistance(nodeId, nextHopId));
+    }
+    return dmsCost * LinkTransmissionPower(nodeId, nextHopId) * bytes / m_config.payloadBytes;
+}
+
+double ProtocolEngine::LinkEnergy(double distance, uint32_t bytes, double dmsCost) const {
+    if (m_radioModel == RADIO_FIRST_ORDER) {
+        return m_radio.TxEnergy(8ULL * bytes, distance);
+    }
+    return dmsCost * TransmissionPower(distance) * bytes / m_config.payloadBytes;
+}
+
+double ProtocolEngine::ReceiveEnergy(uint32_t bytes) const {
+    return m_radioModel == RADIO_FIRST_ORDER ? m_radio.RxEnergy(8ULL * bytes) : 0.0;
+}
+
+void ProtocolEngine::ApplyLinkTxPower(uint32_t nodeId) {
+    if (nodeId >= m_devices.GetN()) {
+        return; // Abstract nodes have no PHY
+    }
+    ns3::Ptr<ns3::WifiPhy> phy = ns3::DynamicCast<ns3::WifiNetDevice>(m_devices.Get(nodeId))->GetPhy();
+    double txPowerDbm = LinkBudgetTxPowerDbm(m_state.linkDistance[nodeId]);
+    phy->SetTxPowerStart(txPowerDbm);
+    phy->SetTxPowerEnd(txPowerDbm);
+}
+
+double ProtocolEngine::LinkTransmissionPower(uint32_t nodeId, uint32_t nextHopId) const {
+    if (m_staticTopology) {
+        return m_state.linkTxPower[nodeId];
+    }
+    return TransmissionPower(MobileDistance(nodeId, nextHopId));
+}
+
+double ProtocolEngine::MobileDistance(uint32_t nodeId, uint32_t nextHopId) const {
+    double now = ns3::Simulator::Now().GetSeconds();
+    ns3::Vector target = nextHopId < m_mobility.GetN() ? m_mobility.GetPosition(nextHopId, now) : GetSinkPosition();
+    return ns3::CalculateDistance(m_mobility.GetPosition(nodeId, now), target);
+}
+
+void ProtocolEngine::SetUplink(uint32_t headId, const ns3::Vector& sink) {
+    double uplink = ns3::CalculateDistance(GetPosition(headId), sink);
+    m_state.SetLink(headId, uplink, TransmissionPower(uplink));
+}
+
+void ProtocolEngine::SetupUplinks() {
+    ns3::Vector sink = GetSinkPosition();
+    m_nextHop.assign(m_clusters.size(), m_registry.GetBaseStationId());
+
+    std::vector<uint32_t> heads; // Serving heads; repaired clusters keep their slot but have none
+    std::vector<ns3::Vector> positions;
+    for (const Cluster& cluster : m_clusters) {
+        uint32_t headId = cluster.clusterHead;
+        if (m_state.IsClusterHead(headId)) {
+            heads.push_back(headId);
+            positions.push_back(GetPosition(headId));
+        }
+    }
+    if (m_routing == ROUTING_DIRECT) {
+        for (uint32_t headId : heads) {
+            SetUplink(headId, sink);
+        }
+        return;
+    }
+
+    // Uplinks are priced like the fused uplinks the variants send; a relay also pays to receive
+    uint32_t bytes = m_config.payloadBytes;
+    double relayReceive = ReceiveEnergy(bytes);
+    m_relay.Build(heads.size(), [&](uint32_t from, uint32_t to) {
+        const ns3::Vector& target = to == RelayTree::kSink ? sink : positions[to];
+        double hop = LinkEnergy(ns3::CalculateDistance(positions[from], target), bytes, m_config.uplinkCost);
+        return to == RelayTree::kSink ? hop : hop + relayReceive;
+    });
+    for (uint32_t i = 0; i < heads.size(); ++i) {
+        uint32_t parent = m_relay.GetParent(i);
+        if (parent == RelayTree::kSink) {
+            SetUplink(heads[i], sink);
+            continue;
+        }
+        m_nextHop[m_state.clusterIndex[heads[i]]] = heads[parent];
+        double distance = ns3::CalculateDistance(positions[i], positions[parent]);
+        m_state.SetLink(heads[i], distance, TransmissionPower(distance));
+        EventRecorder::Get().Record(RECORD_HEAD_RELAY, heads[i], heads[parent], m_relay.GetHopCount(i));
+    }
+}
+
+uint32_t ProtocolEngine::GetNextHop(uint32_t headId) const {
+    uint32_t cluster = m_state.clusterIndex[headId];
+    if (cluster >= m_nextHop.size()) {
+        return m_registry.GetBaseStationId();
+    }
+    return m_nextHop[cluster];
+}
+
+ns3::Ptr<ns3::NetDevice> ProtocolEngine::GetUplinkTarget(uint32_t headId) const {
+    uint32_t nextHop = GetNextHop(headId);
+    if (m_registry.IsBaseStation(nextHop)) {
+        return m_baseStationDevice;
+    }
+    return m_devices.Get(nextHop);
+}
+
+} // namespace leach
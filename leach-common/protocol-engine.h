@@ -0,0 +1,466 @@
+#ifndef LEACH_PROTOCOL_ENGINE_H
+#define LEACH_PROTOCOL_ENGINE_H
+
+#include "abstract-link-table.h"
+#include "checkpoint.h"
+#include "cluster-head-index.h"
+#include "field-partition.h"
+#include "mobility-tracker.h"
+#include "node-random-streams.h"
+#include "node-registry.h"
+#include "node-state-table.h"
+#include "protocol-policies.h"
+#include "radio-model.h"
+#include "relay-tree.h"
+#include "round-scheduler.h"
+#include "simulation-config.h"
+#include "worker-pool.h"
+
+#include "ns3/device-energy-model-container.h"
+#include "ns3/energy-source-container.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// How cluster heads are drawn
+enum ElectionPolicyKind : uint8_t {
+    ELECTION_PROBABILITY = 0, // ProbabilityElection
+    ELECTION_THRESHOLD,       // ThresholdElection
+    ELECTION_ENERGY,          // EnergyWeightedElection
+};
+
+// Where node energy comes from
+enum EnergyModelKind : uint8_t {
+    ENERGY_MANUAL = 0, // ManualEnergy: charged explicitly through UpdateEnergy
+    ENERGY_BASIC,      // BasicEnergy: BasicEnergySource drained by WifiRadioEnergyModel
+};
+
+// How a transmission power level is picked
+enum PowerPolicyKind : uint8_t {
+    POWER_DMS = 0,  // DmsPower
+    POWER_PRIORITY, // PriorityPower
+};
+
+// How a head's fused uplink reaches the base station
+enum RoutingKind : uint8_t {
+    ROUTING_DIRECT = 0, // One hop straight to the sink
+    ROUTING_RELAY,      // Along this round's RelayTree through nearer heads
+};
+
+// What a transmission costs
+enum RadioModelKind : uint8_t {
+    RADIO_DMS = 0,     // A fixed cost per power level and payload
+    RADIO_FIRST_ORDER, // FirstOrderRadio: electronics plus d^2 / d^4 amplifier energy
+};
+
+// Nodes by registry ID
+struct Cluster {
+    uint32_t clusterHead = NodeStateTable::kNone;
+    uint32_t backupHead = NodeStateTable::kNone; // Successor if the head fails; kNone without --backupHeads
+    std::vector<uint32_t> members;
+    double reach = 0.0; // Longest member link set since formation; bounds mobile re-checks
+};
+
+// The parts every basic-network variant shares: node and Wi-Fi setup, the
+// energy model, cluster-head election, cluster formation and repair, and DMS
+// power selection. Variants keep their own traffic, logging and reporting and
+// pick the energy model and policies through SimulationConfig, so they all run
+// on the same state table, spatial index and round scheduler. The policies are
+// resolved once per call, never per node: each loop over the nodes runs as a
+// specialization on the policy types in protocol-policies.h.
+//
+// Setup order: CreateNodes, SetupNodes, SetupEnergyModel, SetMobility.
+// The base station is a real node created after the sensors, so sensor IDs
+// stay dense in [0, numNodes) and it never appears in the state table. Every
+// interface takes node IDs from the NodeRegistry, so events scheduled on them
+// carry integers only.
+//
+// With config.threads above 1, election and formation on large fields split
+// the nodes between a WorkerPool. Each node draws from its own stream and
+// only reads the head index, so the chunks run independently. Their results
+// are merged in ID order, giving the same heads, members and event log as
+// the serial loop for the same seed.
+//
+// Under MPI every rank builds the whole field but only elects, joins and
+// charges the nodes its FieldPartition region owns, so clusters and relay
+// trees stay rank-local and only the last hop to the base station leaves the
+// region. Statistics that span the field go through the collectives in
+// distributed.h.
+class ProtocolEngine {
+public:
+    explicit ProtocolEngine(const SimulationConfig& config);
+
+    // Create config.numNodes sensors with one election stream each, then the
+    // base station; resolves the policies and the rank layout
+    void CreateNodes();
+
+    // Install 802.11b ad-hoc Wi-Fi and IPv4 on the sensors and the base station; nothing in
+    // abstract-radio mode, where links go through the link table instead
+    void SetupNodes();
+
+    // Size the state table and, for the basic model, install energy sources and
+    // radio models; with the first-order radio the Tx current follows the PHY power
+    void SetupEnergyModel();
+
+    // Return a built network to its state right after setup for the next sweep
+    // point: re-resolve the policies from the config, refill every node with
+    // config.initialEnergy, restart the RNG streams and drop clusters and
+    // pending traffic. Nodes, devices, positions and the energy model stay,
+    // which is why mobile topologies cannot be reset.
+    void ResetProtocolState();
+
+    // Place the sensors and the base station, cache the sensor positions, detect
+    // a static topology and split the field between the ranks. Ownership is
+    // fixed here, so mobile nodes stay with the rank they started on. Mobile
+    // sensors are followed through their CourseChange traces from then on.
+    void SetMobility();
+
+    // Mobile topologies: re-check the nodes that strayed hysteresis / 4 from
+    // where their assignment was last checked. Their cached position and link
+    // are refreshed and moved heads are re-indexed. A moved head re-checks its
+    // own members and those of every cluster it may now be nearer to; a member
+    // switches heads only when another is closer by more than config.hysteresis.
+    // O(1) while nobody crosses, so variants call it every frame; a no-op when
+    // static.
+    void UpdateMobileNodes();
+
+    // Start a new round: retire the previous round's events, clear clusters and
+    // elect heads among live nodes with at least config.minHeadEnergy; every
+    // 1/p rounds a new epoch makes all nodes eligible again.
+    // Returns the number of heads.
+    uint32_t ElectClusterHeads();
+
+    // Join every live non-head node to its nearest head and pick backups if enabled
+    void FormClusters();
+
+    void ClearClusters();
+    void BuildClusterHeadIndex();
+
+    // Append a node to a head's cluster and cache the link to it
+    void AddMember(uint32_t nodeId, uint32_t headId, double distance);
+
+    // O(1) removal through the member's back-reference
+    void RemoveMember(uint32_t nodeId);
+
+    // A head failed: drop it from the index and re-home only its members
+    void RepairCluster(uint32_t headId);
+
+    // Pick the live member with the most energy as the cluster's successor
+    void SelectBackupHead(uint32_t cluster);
+
+    // Hand a failed head's cluster to its backup without re-election; the
+    // members only relink. O(cluster size); false if there is no live backup.
+    bool PromoteBackupHead(uint32_t headId);
+
+    // Capture energy, liveness, clusters, the round counter and every RNG
+    // stream's position; the caller fills in time and firstDeathTime
+    void SaveCheckpoint(Checkpoint& checkpoint) const;
+
+    // Resume from a checkpoint instead of the warm-up: call after SetMobility in
+    // a run with the same seed, run and node count, under the manual model.
+    // Rebuilds this round's clusters, index and uplinks; fatal on a mismatch.
+    void RestoreCheckpoint(const Checkpoint& checkpoint);
+
+    // Charge a node under the manual model; returns its remaining energy. A
+    // no-op under the basic model, where the radio energy model drains the sources.
+    double UpdateEnergy(uint32_t nodeId, double energyUsed);
+
+    // Copy every source's remaining energy into the state table; nothing to do under the manual model
+    void SyncEnergy();
+
+    // Mean energy of the whole field: each rank's own nodes, summed over all
+    // ranks. A collective under MPI, so every rank must call it at the same point.
+    double GlobalAverageEnergy() const;
+
+    // Power level for a link of the given length
+    double TransmissionPower(double distance, bool highPriority = false) const;
+
+    // Power for a node's current next hop; static topologies read the value
+    // cached at formation, mobile ones the current length of the tracked link
+    double LinkTransmissionPower(uint32_t nodeId, uint32_t nextHopId) const;
+
+    // Cache a head's uplink to the sink
+    void SetUplink(uint32_t headId, const ns3::Vector& sink);
+
+    // Route every serving head for the rest of the round: straight to the
+    // sink, or along a relay tree of cheapest-energy paths. Caches each head's
+    // link to its next hop; repair and promotion re-run it.
+    void SetupUplinks();
+
+    // Where a head sends its uplink: another head under relay routing, else the base station
+    uint32_t GetNextHop(uint32_t headId) const;
+
+    // Device of a head's next hop, the address its uplink goes to on the full
+    // stack; abstract-radio runs install no devices and must not call it
+    ns3::Ptr<ns3::NetDevice> GetUplinkTarget(uint32_t headId) const;
+
+    // Carry a head's uplink of the given size to the base station, calling
+    // charge(nodeId, energy) for every hop's transmission and every relay's
+    // reception; returns the hop count
+    template <class Charge>
+    uint32_t ForwardUplink(uint32_t headId, uint32_t bytes, double dmsCost, Charge charge) const {
+        uint32_t hops = 1;
+        uint32_t sender = headId;
+        uint32_t nextHop = GetNextHop(headId);
+        charge(sender, TransmitEnergy(sender, nextHop, bytes, dmsCost));
+        while (!m_registry.IsBaseStation(nextHop)) {
+            charge(nextHop, ReceiveEnergy(bytes));
+            sender = nextHop;
+            nextHop = GetNextHop(sender);
+            charge(sender, TransmitEnergy(sender, nextHop, bytes, dmsCost));
+            hops++;
+        }
+        return hops;
+    }
+
+    // Charge one frame of a cluster's reports: each member's transmission of
+    // bytes to headId and the head's reception of it. The energy and power
+    // policies are picked once here, so the per-member charges do not branch
+    // on them. report(memberId, txPower) runs before a member's charges and
+    // charged(nodeId, energyBefore) after each charge.
+    template <class Report, class Charged>
+    void ChargeClusterFrame(uint32_t headId, uint32_t bytes, double dmsCost, Report report, Charged charged) {
+        switch (m_energyModel) {
+        case ENERGY_MANUAL:
+            ChargeFrameWithEnergy<ManualEnergy>(headId, bytes, dmsCost, report, charged);
+            break;
+        case ENERGY_BASIC:
+            ChargeFrameWithEnergy<BasicEnergy>(headId, bytes, dmsCost, report, charged);
+            break;
+        }
+    }
+
+    // Length of a node's link to its next hop; static topologies read the value
+    // cached at formation, mobile ones extrapolate from the last course changes
+    double LinkDistance(uint32_t nodeId, uint32_t nextHopId) const;
+
+    // Energy a node spends sending bytes to its next hop. The DMS model charges
+    // dmsCost per power level and payload; the first-order model charges by
+    // packet size and link length and ignores dmsCost.
+    double TransmitEnergy(uint32_t nodeId, uint32_t nextHopId, uint32_t bytes, double dmsCost) const;
+
+    // The same for a link of the given length
+    double LinkEnergy(double distance, uint32_t bytes, double dmsCost) const;
+
+    // Energy to receive bytes; zero under the DMS model, which only charges senders
+    double ReceiveEnergy(uint32_t bytes) const;
+
+    // Set the node's PHY TxPowerStart/End to what its cached link needs, so
+    // short links also shrink the range the channel model sees
+    void ApplyLinkTxPower(uint32_t nodeId);
+
+    ns3::Vector GetPosition(uint32_t nodeId) const {
+        return ns3::Vector(m_state.x[nodeId], m_state.y[nodeId], m_state.z[nodeId]);
+    }
+
+    NodeStateTable& GetState() {
+        return m_state;
+    }
+
+    std::vector<Cluster>& GetClusters() {
+        return m_clusters;
+    }
+
+    ClusterHeadIndex& GetClusterHeadIndex() {
+        return m_index;
+    }
+
+    NodeRandomStreams& GetElectionStreams() {
+        return m_streams;
+    }
+
+    RoundScheduler& GetRoundScheduler() {
+        return m_scheduler;
+    }
+
+    const NodeRegistry& GetRegistry() const {
+        return m_registry;
+    }
+
+    // The sensors, for ns-3 helpers
+    const ns3::NodeContainer& GetNodes() const {
+        return m_registry.GetSensors();
+    }
+
+    const ns3::Ptr<ns3::Node>& GetBaseStation() const {
+        return m_registry.GetBaseStation();
+    }
+
+    uint32_t GetBaseStationId() const {
+        return m_registry.GetBaseStationId();
+    }
+
+    ns3::Vector GetSinkPosition() const {
+        return ns3::Vector(m_config.sinkX, m_config.sinkY, 0.0);
+    }
+
+    const ns3::Ptr<ns3::Node>& GetNode(uint32_t nodeId) const {
+        return m_registry.Get(nodeId);
+    }
+
+    ns3::NetDeviceContainer GetDevices() const {
+        return m_devices;
+    }
+
+    ns3::Ptr<ns3::NetDevice> GetDevice(uint32_t nodeId) const {
+        return m_devices.Get(nodeId);
+    }
+
+    // Whether this rank simulates the node
+    bool IsLocal(uint32_t nodeId) const {
+        return m_partition.IsLocal(nodeId);
+    }
+
+    const FieldPartition& GetPartition() const {
+        return m_partition;
+    }
+
+    bool IsAbstractRadio() const {
+        return m_config.abstractRadio;
+    }
+
+    AbstractLinkTable& GetLinkTable() {
+        return m_links;
+    }
+
+    ns3::energy::EnergySourceContainer GetEnergySources() const {
+        return m_sources;
+    }
+
+    ns3::energy::DeviceEnergyModelContainer GetRadioModels() const {
+        return m_radioModels;
+    }
+
+    EnergyModelKind GetEnergyModel() const {
+        return m_energyModel;
+    }
+
+    bool IsStaticTopology() const {
+        return m_staticTopology;
+    }
+
+    // Elections held so far
+    uint32_t GetRound() const {
+        return m_round;
+    }
+
+private:
+    // Map the config's policy strings onto the enums; fatal on unknown names
+    void ResolvePolicies();
+
+    // CourseChange sink of every mobile sensor
+    void CourseChanged(ns3::Ptr<const ns3::MobilityModel> model);
+
+    // Copy every mobile sensor's current position into the state table
+    void SnapshotMobilePositions();
+
+    // Current length of a link between two sensors, or a sensor and the base station
+    double MobileDistance(uint32_t nodeId, uint32_t nextHopId) const;
+
+    template <class Election>
+    void ElectWith();
+
+    // Whether a node becomes head this round; always advances its stream
+    template <class Election>
+    bool Elects(const ElectionContext& ctx, uint32_t nodeId);
+
+    void AddClusterHead(uint32_t nodeId);
+
+    template <class Power>
+    void FormWith();
+
+    // Nearest head for a live local non-head; false if it joins no cluster
+    bool FindHead(uint32_t nodeId, uint32_t& headId, double& distance) const;
+
+    // Split a loop over n nodes between the pool's threads
+    bool UseWorkers(uint32_t n) const;
+
+    template <class Power>
+    void AddMemberWith(uint32_t nodeId, uint32_t headId, double distance);
+
+    template <class Energy, class Report, class Charged>
+    void ChargeFrameWithEnergy(uint32_t headId, uint32_t bytes, double dmsCost, Report& report, Charged& charged) {
+        switch (m_powerPolicy) {
+        case POWER_DMS:
+            ChargeFrameWith<Energy, DmsPower>(headId, bytes, dmsCost, report, charged);
+            break;
+        case POWER_PRIORITY:
+            ChargeFrameWith<Energy, PriorityPower>(headId, bytes, dmsCost, report, charged);
+            break;
+        }
+    }
+
+    // The same charges as TransmitEnergy and ReceiveEnergy, with the policies fixed
+    template <class Energy, class Power, class Report, class Charged>
+    void ChargeFrameWith(uint32_t headId, uint32_t bytes, double dmsCost, Report& report, Charged& charged) {
+        const std::vector<uint32_t>& members = m_clusters[m_state.clusterIndex[headId]].members;
+        bool firstOrder = m_radioModel == RADIO_FIRST_ORDER;
+        double rxEnergy = ReceiveEnergy(bytes);
+        for (uint32_t memberId : members) {
+            double distance = LinkDistance(memberId, headId);
+            double txPower = m_staticTopology ? m_state.linkTxPower[memberId] : Power::Power(distance, false);
+            report(memberId, txPower);
+
+            double txEnergy = firstOrder ? m_radio.TxEnergy(8ULL * bytes, distance)
+                                         : dmsCost * txPower * bytes / m_config.payloadBytes;
+            double before = m_state.energy[memberId];
+            Energy::Charge(m_state.energy[memberId], txEnergy);
+            charged(memberId, before);
+            before = m_state.energy[headId];
+            Energy::Charge(m_state.energy[headId], rxEnergy);
+            charged(headId, before);
+        }
+    }
+
+    const SimulationConfig& m_config;
+    ElectionPolicyKind m_election;
+    EnergyModelKind m_energyModel;
+    PowerPolicyKind m_powerPolicy;
+    RadioModelKind m_radioModel;
+    RoutingKind m_routing;
+    FirstOrderRadio m_radio;
+    bool m_staticTopology; // No node moves, so link distances are cached at formation
+    MobilityTracker m_mobility; // Sensor trajectories and assignment anchors; empty when static
+    std::vector<uint32_t> m_crossed; // Scratch for UpdateMobileNodes
+    std::vector<uint32_t> m_recheck;
+    std::vector<uint32_t> m_recheckClusters;
+
+    // A node's nearest head, found by a formation worker
+    struct Join {
+        uint32_t node;
+        uint32_t head;
+        double distance;
+    };
+
+    WorkerPool m_pool;
+    std::vector<std::vector<uint32_t>> m_electedChunks; // Heads per worker chunk, in ID order
+    std::vector<std::vector<Join>> m_joinChunks;        // Joins per worker chunk, in ID order
+    uint32_t m_round; // Elections held so far
+    uint32_t m_epochLength; // Rounds per epoch, 1/p
+
+    NodeRegistry m_registry;
+    ns3::NetDeviceContainer m_devices; // Sensor devices only, so they pair with the energy sources
+    ns3::Ptr<ns3::NetDevice> m_baseStationDevice;
+    ns3::energy::EnergySourceContainer m_sources;
+    ns3::energy::DeviceEnergyModelContainer m_radioModels;
+
+    NodeStateTable m_state;
+    std::vector<Cluster> m_clusters; // Clusters of the current round, in election order
+    std::vector<uint32_t> m_nextHop; // Uplink next hop per cluster, a head or the base station
+    RelayTree m_relay;
+    ClusterHeadIndex m_index;
+    FieldPartition m_partition;
+    NodeRandomStreams m_streams;
+    AbstractLinkTable m_links;
+    RoundScheduler m_scheduler;
+};
+
+} // namespace leach
+
+#endif // LEACH_PROTOCOL_ENGINE_H
@@ -0,0 +1,106 @@
+#ifndef LEACH_PROTOCOL_POLICIES_H
+#define LEACH_PROTOCOL_POLICIES_H
+
+#include "node-state-table.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace leach {
+
+// Compile-time policies for the engine's per-node hot paths. ProtocolEngine
+// resolves the configured policy once per call and runs its loop over the
+// nodes through a specialization, so these static members inline into it
+// instead of being looked up per node.
+
+// What an election policy sees for the current round
+struct ElectionContext {
+    double p;              // Desired fraction of heads per round
+    uint32_t roundInEpoch; // r mod 1/p
+    double averageEnergy;  // Mean node energy; only filled for policies with kUsesAverageEnergy (J)
+};
+
+// Plain draw: every eligible node becomes head with probability p each round,
+// so a node can be head many rounds in a row
+struct ProbabilityElection {
+    static constexpr bool kUsesAverageEnergy = false;
+
+    static double Threshold(const ElectionContext& ctx, const NodeStateTable&, uint32_t) {
+        return ctx.p;
+    }
+};
+
+// LEACH threshold T(n) = p / (1 - p (r mod 1/p)) for nodes that have not been
+// head this epoch, 0 for the rest. The threshold rises through the epoch until
+// every remaining node is elected in its last round, so each node serves once
+// per 1/p rounds and about p N heads are elected every round.
+struct ThresholdElection {
+    static constexpr bool kUsesAverageEnergy = false;
+
+    static double Threshold(const ElectionContext& ctx, const NodeStateTable& state, uint32_t nodeId) {
+        if (state.headThisEpoch[nodeId]) {
+            return 0.0;
+        }
+        double denominator = 1.0 - ctx.p * ctx.roundInEpoch;
+        return denominator > ctx.p ? ctx.p / denominator : 1.0;
+    }
+};
+
+// T(n) scaled by the node's energy relative to the mean, so nodes with more
+// energy left serve more often and the load drains the field evenly
+struct EnergyWeightedElection {
+    static constexpr bool kUsesAverageEnergy = true;
+
+    static double Threshold(const ElectionContext& ctx, const NodeStateTable& state, uint32_t nodeId) {
+        double threshold = ThresholdElection::Threshold(ctx, state, nodeId);
+        if (ctx.averageEnergy <= 0.0) {
+            return threshold;
+        }
+        return std::min(1.0, threshold * state.energy[nodeId] / ctx.averageEnergy);
+    }
+};
+
+// DMS: three distance bands
+struct DmsPower {
+    static double Power(double distance, bool) {
+        double basePower = 1.0; // Base power level
+        if (distance > 50.0) {
+            return basePower * 1.5; // Higher power for long distances
+        } else if (distance > 20.0) {
+            return basePower * 1.2; // Moderate power for medium distances
+        }
+        return basePower * 0.8; // Lower power for short distances
+    }
+};
+
+// Urgent data at full power, otherwise two distance bands
+struct PriorityPower {
+    static double Power(double distance, bool highPriority) {
+        double basePower = 1.0; // Base power level
+        if (highPriority) {
+            return basePower * 1.5; // Higher power for urgent data
+        } else if (distance > 50.0) {
+            return basePower * 1.2; // Moderate power for longer distances
+        }
+        return basePower * 0.8; // Low power for short distances
+    }
+};
+
+// Energy charged explicitly per transmission
+struct ManualEnergy {
+    static double Charge(double& energy, double energyUsed) {
+        energy = std::max(0.0, energy - energyUsed);
+        return energy;
+    }
+};
+
+// BasicEnergySource drained by WifiRadioEnergyModel; the table is synced from the sources
+struct BasicEnergy {
+    static double Charge(double& energy, double) {
+        return energy; // The radio energy model drains the sources itself
+    }
+};
+
+} // namespace leach
+
+#endif // LEACH_PROTOCOL_POLICIES_H
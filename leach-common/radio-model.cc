@@ -0,0 +1,37 @@
+#include "radio-model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace leach {
+
+namespace {
+
+const double kReferenceLossDb = 46.6777; // LogDistancePropagationLossModel at 1 m
+const double kPathLossExponent = 3.0;
+const double kRxSensitivityDbm = -101.0; // YansWifiPhy default
+const double kLinkMarginDb = 10.0;       // Headroom for fading and interference
+const double kMinTxPowerDbm = -10.0;
+const double kMaxTxPowerDbm = 16.0206;   // YansWifiPhy default TxPowerStart/End
+
+} // namespace
+
+FirstOrderRadio::FirstOrderRadio() {
+    SetParameters(50e-9, 10e-12, 0.0013e-12);
+}
+
+void FirstOrderRadio::SetParameters(double electronics, double freeSpace, double multipath) {
+    m_electronics = electronics;
+    m_freeSpace = freeSpace;
+    m_multipath = multipath;
+    m_crossover = multipath > 0.0 ? std::sqrt(freeSpace / multipath) : std::numeric_limits<double>::infinity();
+}
+
+double LinkBudgetTxPowerDbm(double distance) {
+    double loss = kReferenceLossDb + 10.0 * kPathLossExponent * std::log10(std::max(1.0, distance));
+    double required = kRxSensitivityDbm + kLinkMarginDb + loss;
+    return std::min(kMaxTxPowerDbm, std::max(kMinTxPowerDbm, required));
+}
+
+} // namespace leach
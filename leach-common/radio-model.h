@@ -0,0 +1,47 @@
+#ifndef LEACH_RADIO_MODEL_H
+#define LEACH_RADIO_MODEL_H
+
+#include <cstdint>
+
+namespace leach {
+
+// First-order radio model (Heinzelman et al.): sending k bits over d metres
+// costs E_elec k + eps_fs k d^2 below the crossover distance
+// d0 = sqrt(eps_fs / eps_mp) and E_elec k + eps_mp k d^4 beyond it; receiving
+// costs E_elec k. Defaults are the usual LEACH constants.
+class FirstOrderRadio {
+public:
+    FirstOrderRadio();
+
+    // Electronics energy per bit and the two amplifier coefficients (J/bit, J/bit/m^2, J/bit/m^4)
+    void SetParameters(double electronics, double freeSpace, double multipath);
+
+    double GetCrossoverDistance() const {
+        return m_crossover;
+    }
+
+    double TxEnergy(uint64_t bits, double distance) const {
+        double d2 = distance * distance;
+        double amplifier = distance < m_crossover ? m_freeSpace * d2 : m_multipath * d2 * d2;
+        return bits * (m_electronics + amplifier);
+    }
+
+    double RxEnergy(uint64_t bits) const {
+        return bits * m_electronics;
+    }
+
+private:
+    double m_electronics; // E_elec (J/bit)
+    double m_freeSpace;   // eps_fs (J/bit/m^2)
+    double m_multipath;   // eps_mp (J/bit/m^4)
+    double m_crossover;   // d0 (m)
+};
+
+// Lowest PHY transmit power (dBm) that closes a link of the given length
+// under the Yans defaults (log-distance loss, exponent 3, 46.6777 dB at 1 m,
+// -101 dBm sensitivity) with a 10 dB margin, clamped to [-10, 16.0206] dBm
+double LinkBudgetTxPowerDbm(double distance);
+
+} // namespace leach
+
+#endif // LEACH_RADIO_MODEL_H
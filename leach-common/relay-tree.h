@@ -0,0 +1,73 @@
+#ifndef LEACH_RELAY_TREE_H
+#define LEACH_RELAY_TREE_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace leach {
+
+// Cheapest path from every cluster head to the sink over the complete graph
+// of heads, rebuilt once per round. Heads are numbered [0, n); cost(u, v) is
+// the energy to move one packet from head u to head v, or to the sink for
+// v == kSink. Dense Dijkstra from the sink: O(n^2) with no heap, which is the
+// right trade for a complete graph of a few dozen heads.
+class RelayTree {
+public:
+    static constexpr uint32_t kSink = std::numeric_limits<uint32_t>::max();
+
+    template <class Cost>
+    void Build(uint32_t n, Cost cost) {
+        m_parent.assign(n, kSink);
+        m_cost.resize(n);
+        m_done.assign(n, 0);
+        for (uint32_t u = 0; u < n; ++u) {
+            m_cost[u] = cost(u, kSink); // The direct hop bounds every path
+        }
+        for (uint32_t settled = 0; settled < n; ++settled) {
+            uint32_t v = kSink;
+            for (uint32_t u = 0; u < n; ++u) {
+                if (!m_done[u] && (v == kSink || m_cost[u] < m_cost[v])) {
+                    v = u;
+                }
+            }
+            m_done[v] = 1;
+            for (uint32_t u = 0; u < n; ++u) {
+                if (!m_done[u]) {
+                    double viaV = cost(u, v) + m_cost[v];
+                    if (viaV < m_cost[u]) {
+                        m_cost[u] = viaV;
+                        m_parent[u] = v;
+                    }
+                }
+            }
+        }
+    }
+
+    // Next hop of a head: another head, or kSink
+    uint32_t GetParent(uint32_t head) const {
+        return m_parent[head];
+    }
+
+    // Energy of the head's whole path to the sink
+    double GetPathCost(uint32_t head) const {
+        return m_cost[head];
+    }
+
+    uint32_t GetHopCount(uint32_t head) const {
+        uint32_t hops = 1;
+        for (uint32_t u = m_parent[head]; u != kSink; u = m_parent[u]) {
+            hops++;
+        }
+        return hops;
+    }
+
+private:
+    std::vector<uint32_t> m_parent;
+    std::vector<double> m_cost;
+    std::vector<uint8_t> m_done;
+};
+
+} // namespace leach
+
+#endif // LEACH_RELAY_TREE_H
@@ -0,0 +1,256 @@
+#include "replication-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/rng-seed-manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace leach {
+
+namespace {
+
+// Flat binary encoding of a RunSummary sent from a worker to the driver
+template <typename T>
+void Append(std::string& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool Extract(const std::string& buffer, std::size_t& offset, T& value) {
+    if (offset + sizeof(T) > buffer.size()) {
+        return false;
+    }
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+std::string Encode(const RunSummary& summary) {
+    std::string buffer;
+    Append(buffer, summary.run);
+    Append(buffer, summary.firstNodeDeathTime);
+    Append(buffer, static_cast<uint32_t>(summary.averageEnergy.size()));
+    for (double e : summary.averageEnergy) {
+        Append(buffer, e);
+    }
+    Append(buffer, static_cast<uint32_t>(summary.clusterHeadCounts.size()));
+    for (uint32_t c : summary.clusterHeadCounts) {
+        Append(buffer, c);
+    }
+    return buffer;
+}
+
+bool Decode(const std::string& buffer, RunSummary& summary) {
+    std::size_t offset = 0;
+    uint32_t n = 0;
+    if (!Extract(buffer, offset, summary.run) || !Extract(buffer, offset, summary.firstNodeDeathTime) ||
+        !Extract(buffer, offset, n)) {
+        return false;
+    }
+    summary.averageEnergy.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!Extract(buffer, offset, summary.averageEnergy[i])) {
+            return false;
+        }
+    }
+    if (!Extract(buffer, offset, n)) {
+        return false;
+    }
+    summary.clusterHeadCounts.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!Extract(buffer, offset, summary.clusterHeadCounts[i])) {
+            return false;
+        }
+    }
+    return offset == buffer.size();
+}
+
+void WriteAll(int fd, const std::string& buffer) {
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            _exit(2);
+        }
+        written += n;
+    }
+}
+
+struct Worker {
+    pid_t pid;
+    uint64_t run;
+    std::string output;
+};
+
+} // namespace
+
+ReplicationRunner::ReplicationRunner(uint32_t replications, uint32_t jobs, uint64_t firstRun)
+    : m_replications(replications), m_jobs(jobs), m_firstRun(firstRun) {
+    if (m_jobs == 0) {
+        m_jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+std::vector<RunSummary> ReplicationRunner::Run(const SimulationFunction& simulate) const {
+    std::vector<RunSummary> results;
+    std::map<int, Worker> active; // Keyed by the read end of the worker's pipe
+    uint32_t launched = 0;
+
+    while (launched < m_replications || !active.empty()) {
+        // Keep the pool full
+        while (launched < m_replications && active.size() < m_jobs) {
+            int fds[2];
+            NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed: " << std::strerror(errno));
+            uint64_t run = m_firstRun + launched;
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork() failed: " << std::strerror(errno));
+            if (pid == 0) {
+                close(fds[0]);
+                ns3::RngSeedManager::SetRun(run);
+                RunSummary summary = simulate(run);
+                summary.run = run;
+                WriteAll(fds[1], Encode(summary));
+                close(fds[1]);
+                _exit(0);
+            }
+            close(fds[1]);
+            active[fds[0]] = Worker{pid, run, std::string()};
+            launched++;
+        }
+
+        // Drain worker pipes as data arrives so no worker blocks on a full pipe
+        std::vector<pollfd> polled;
+        for (const auto& entry : active) {
+            polled.push_back(pollfd{entry.first, POLLIN, 0});
+        }
+        if (poll(polled.data(), polled.size(), -1) < 0) {
+            NS_ABORT_MSG_IF(errno != EINTR, "poll() failed: " << std::strerror(errno));
+            continue;
+        }
+        for (const pollfd& p : polled) {
+            if (!(p.revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            Worker& worker = active[p.fd];
+            char chunk[65536];
+            ssize_t n = read(p.fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                worker.output.append(chunk, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            // End of stream: reap the worker and keep its summary if it finished cleanly
+            close(p.fd);
+            int status = 0;
+            waitpid(worker.pid, &status, 0);
+            RunSummary summary;
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && Decode(worker.output, summary)) {
+                results.push_back(summary);
+            } else {
+                std::cerr << "Replication run " << worker.run << " failed" << std::endl;
+            }
+            active.erase(p.fd);
+        }
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const RunSummary& a, const RunSummary& b) { return a.run < b.run; });
+    return results;
+}
+
+ReplicationSummary ReplicationRunner::Merge(const std::vector<RunSummary>& runs) {
+    ReplicationSummary merged;
+    merged.runs = runs.size();
+    if (runs.empty()) {
+        return merged;
+    }
+
+    // First node death, over the runs in which a node died
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (const RunSummary& run : runs) {
+        if (run.firstNodeDeathTime >= 0.0) {
+            merged.runsWithDeath++;
+            sum += run.firstNodeDeathTime;
+            sumSquares += run.firstNodeDeathTime * run.firstNodeDeathTime;
+        }
+    }
+    if (merged.runsWithDeath > 0) {
+        double n = merged.runsWithDeath;
+        merged.firstNodeDeathMean = sum / n;
+        if (merged.runsWithDeath > 1) {
+            double variance = std::max(0.0, (sumSquares - n * merged.firstNodeDeathMean * merged.firstNodeDeathMean) / (n - 1));
+            merged.firstNodeDeathStdDev = std::sqrt(variance);
+            merged.firstNodeDeathCi95 = 1.96 * merged.firstNodeDeathStdDev / std::sqrt(n);
+        }
+    }
+
+    // Curves are averaged over the samples every run has
+    std::size_t energySamples = runs[0].averageEnergy.size();
+    std::size_t rounds = runs[0].clusterHeadCounts.size();
+    for (const RunSummary& run : runs) {
+        energySamples = std::min(energySamples, run.averageEnergy.size());
+        rounds = std::min(rounds, run.clusterHeadCounts.size());
+    }
+    merged.averageEnergy.assign(energySamples, 0.0);
+    merged.clusterHeadCounts.assign(rounds, 0.0);
+    for (const RunSummary& run : runs) {
+        for (std::size_t i = 0; i < energySamples; ++i) {
+            merged.averageEnergy[i] += run.averageEnergy[i] / runs.size();
+        }
+        for (std::size_t r = 0; r < rounds; ++r) {
+            merged.clusterHeadCounts[r] += static_cast<double>(run.clusterHeadCounts[r]) / runs.size();
+        }
+    }
+    for (double c : merged.clusterHeadCounts) {
+        merged.meanClusterHeads += c;
+    }
+    if (rounds > 0) {
+        merged.meanClusterHeads /= rounds;
+    }
+    return merged;
+}
+
+void ReplicationRunner::Print(std::ostream& os, const std::vector<RunSummary>& runs, const ReplicationSummary& summary) {
+    os << "run\tfirstNodeDeath(s)\tfinalAverageEnergy(J)\tmeanClusterHeads" << std::endl;
+    for (const RunSummary& run : runs) {
+        double heads = 0.0;
+        for (uint32_t c : run.clusterHeadCounts) {
+            heads += c;
+        }
+        os << run.run << "\t" << run.firstNodeDeathTime << "\t"
+           << (run.averageEnergy.empty() ? 0.0 : run.averageEnergy.back()) << "\t"
+           << (run.clusterHeadCounts.empty() ? 0.0 : heads / run.clusterHeadCounts.size()) << std::endl;
+    }
+
+    os << "Replications: " << summary.runs << " (" << summary.runsWithDeath << " with a node death)" << std::endl;
+    if (summary.runsWithDeath > 0) {
+        os << "First node death: " << summary.firstNodeDeathMean << " s +/- " << summary.firstNodeDeathCi95
+           << " (95% CI, stddev " << summary.firstNodeDeathStdDev << ")" << std::endl;
+    }
+    os << "Mean cluster heads per round: " << summary.meanClusterHeads << std::endl;
+    os << "Average energy curve (J):";
+    for (double e : summary.averageEnergy) {
+        os << " " << e;
+    }
+    os << std::endl;
+}
+
+} // namespace leach
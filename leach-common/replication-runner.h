@@ -0,0 +1,55 @@
+#ifndef LEACH_REPLICATION_RUNNER_H
+#define LEACH_REPLICATION_RUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace leach {
+
+// What one simulation run reports back to the replication driver
+struct RunSummary {
+    uint64_t run = 0;
+    double firstNodeDeathTime = -1.0;         // Seconds, or -1 if every node survived
+    std::vector<double> averageEnergy;        // Network average energy at each report (J)
+    std::vector<uint32_t> clusterHeadCounts;  // Heads elected in each round
+};
+
+// Statistics merged over all replications
+struct ReplicationSummary {
+    uint32_t runs = 0;
+    uint32_t runsWithDeath = 0;
+    double firstNodeDeathMean = 0.0;
+    double firstNodeDeathStdDev = 0.0;
+    double firstNodeDeathCi95 = 0.0;          // Half-width of the normal 95% interval
+    std::vector<double> averageEnergy;        // Pointwise mean over runs
+    std::vector<double> clusterHeadCounts;    // Mean heads per round over runs
+    double meanClusterHeads = 0.0;
+};
+
+// Runs independent simulations across a pool of worker processes. ns-3's
+// Simulator is a process-wide singleton, so every replication gets its own
+// forked process; each one calls RngSeedManager::SetRun with its run number
+// before the simulation function starts, giving it a separate RNG stream.
+class ReplicationRunner {
+public:
+    typedef std::function<RunSummary(uint64_t run)> SimulationFunction;
+
+    // Run numbers are firstRun, firstRun + 1, ...; jobs == 0 uses every core
+    ReplicationRunner(uint32_t replications, uint32_t jobs, uint64_t firstRun);
+
+    std::vector<RunSummary> Run(const SimulationFunction& simulate) const;
+
+    static ReplicationSummary Merge(const std::vector<RunSummary>& runs);
+    static void Print(std::ostream& os, const std::vector<RunSummary>& runs, const ReplicationSummary& summary);
+
+private:
+    uint32_t m_replications;
+    uint32_t m_jobs;
+    uint64_t m_firstRun;
+};
+
+} // namespace leach
+
+#endif // LEACH_REPLICATION_RUNNER_H
@@ -0,0 +1,79 @@
+#ifndef LEACH_ROUND_SCHEDULER_H
+#define LEACH_ROUND_SCHEDULER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace leach {
+
+// Owns the events scheduled on behalf of one LEACH round. Starting a new round
+// cancels whatever the previous round still has pending, so the self-rescheduling
+// traffic chains never outlive the cluster layout they were created for and the
+// event queue stays O(nodes) regardless of simulated time.
+class RoundScheduler {
+public:
+    RoundScheduler() : m_round(0), m_compactAt(kMinCompact) {}
+
+    // Cancel every pending event of the current round and advance the round counter
+    uint32_t BeginRound() {
+        uint64_t cancelled = 0;
+        for (ns3::EventId& id : m_events) {
+            if (!id.IsExpired()) {
+                id.Cancel();
+                ++cancelled;
+            }
+        }
+        Profiler::Get().OnCancelled(cancelled);
+        m_events.clear();
+        m_compactAt = kMinCompact;
+        return ++m_round;
+    }
+
+    // Schedule an event that belongs to the current round
+    template <typename FUNC, typename... Ts>
+    ns3::EventId Schedule(const ns3::Time& delay, FUNC f, Ts&&... args) {
+        if (m_events.size() >= m_compactAt) {
+            Compact();
+        }
+        ns3::EventId id = ns3::Simulator::Schedule(delay, f, std::forward<Ts>(args)...);
+        m_events.push_back(id);
+        return id;
+    }
+
+    uint32_t GetRound() const {
+        return m_round;
+    }
+
+    // Number of tracked events that have not yet run or been cancelled
+    std::size_t GetPendingCount() const {
+        return std::count_if(m_events.begin(), m_events.end(),
+                             [](const ns3::EventId& id) { return !id.IsExpired(); });
+    }
+
+private:
+    static constexpr std::size_t kMinCompact = 64;
+
+    // Drop handles of events that already fired; keeps the vector proportional to
+    // the number of live chains instead of the number of events ever scheduled.
+    void Compact() {
+        m_events.erase(std::remove_if(m_events.begin(), m_events.end(),
+                                      [](const ns3::EventId& id) { return id.IsExpired(); }),
+                       m_events.end());
+        m_compactAt = std::max(kMinCompact, 2 * m_events.size());
+    }
+
+    uint32_t m_round;
+    std::size_t m_compactAt;
+    std::vector<ns3::EventId> m_events;
+};
+
+} // namespace leach
+
+#endif // LEACH_ROUND_SCHEDULER_H
@@ -0,0 +1,40 @@
+#include "simulation-config.h"
+
+namespace leach {
+
+void SimulationConfig::AddValues(ns3::CommandLine& cmd) {
+    cmd.AddValue("nodes", "Number of sensor nodes", numNodes);
+    cmd.AddValue("fieldSize", "Side of the square sensor field (m)", fieldSize);
+    cmd.AddValue("clusterHeadProbability", "Probability p that a node becomes a cluster head", clusterHeadProbability);
+    cmd.AddValue("duration", "Simulated time (s)", duration);
+    cmd.AddValue("initialEnergy", "Initial energy per node (J)", initialEnergy);
+    cmd.AddValue("topology", "Node placement: line, uniform, grid or clustered", topology);
+    cmd.AddValue("hotspots", "Number of cluster centers for the clustered topology", hotspots);
+    cmd.AddValue("hotspotSpread", "Standard deviation of node placement around a center (m)", hotspotSpread);
+    cmd.AddValue("mobility", "Sensor movement: static, walk (random walk) or waypoint (random waypoint); the base station stays put", mobility);
+    cmd.AddValue("nodeSpeed", "Speed of mobile sensors (m/s)", nodeSpeed);
+    cmd.AddValue("hysteresis", "Margin a closer head must win by before a moving member switches to it (m)", hysteresis);
+    cmd.AddValue("frameLength", "TDMA frame length; each member reports once per frame (s)", frameLength);
+    cmd.AddValue("payloadBytes", "Size of one member reading (bytes)", payloadBytes);
+    cmd.AddValue("aggregationCorrelation", "Redundancy between readings fused by a head: 1 = one reading, 0 = concatenation", aggregationCorrelation);
+    cmd.AddValue("uplinkCost", "DMS cost per power level of a head's fused uplink; also prices the relay tree", uplinkCost);
+    cmd.AddValue("election", "Cluster-head election policy: probability (flat p per round), threshold (LEACH T(n)) or energy (T(n) weighted by remaining energy)", election);
+    cmd.AddValue("energyModel", "Energy accounting: manual or basic (BasicEnergySource)", energyModel);
+    cmd.AddValue("powerPolicy", "Transmission power mapping: dms (by distance) or priority (urgent data at full power)", powerPolicy);
+    cmd.AddValue("radioModel", "Transmission cost: dms (fixed per power level) or firstorder (E_elec k + eps k d^2 / d^4)", radioModel);
+    cmd.AddValue("radioElectronics", "First-order radio electronics energy (J/bit)", radioElectronics);
+    cmd.AddValue("radioFreeSpace", "First-order free-space amplifier energy (J/bit/m^2)", radioFreeSpace);
+    cmd.AddValue("radioMultipath", "First-order multipath amplifier energy (J/bit/m^4)", radioMultipath);
+    cmd.AddValue("abstractRadio", "Skip the Wi-Fi and IP stacks and model links analytically (needs --energyModel=manual)", abstractRadio);
+    cmd.AddValue("linkBands", "Abstract-radio loss per distance band as maxDistance:loss,... (lost beyond the last band)", linkBands);
+    cmd.AddValue("abstractDataRate", "Abstract-radio link rate (bit/s)", abstractDataRate);
+    cmd.AddValue("sinkX", "Base station x position (m)", sinkX);
+    cmd.AddValue("sinkY", "Base station y position (m)", sinkY);
+    cmd.AddValue("routing", "Head uplinks: direct to the base station or relay through a per-round cheapest-energy tree of heads", routing);
+    cmd.AddValue("minHeadEnergy", "Minimum energy for a node to be elected cluster head (J)", minHeadEnergy);
+    cmd.AddValue("backupHeads", "Pick a backup per cluster and promote it when the head fails", backupHeads);
+    cmd.AddValue("stopDeadFraction", "End the run once this fraction of nodes has died (0 = run the full duration, 1 = last node death)", stopDeadFraction);
+    cmd.AddValue("threads", "Threads for cluster-head election and formation (0 = one per core); results are identical to one thread", threads);
+}
+
+} // namespace leach
@@ -0,0 +1,55 @@
+#ifndef LEACH_SIMULATION_CONFIG_H
+#define LEACH_SIMULATION_CONFIG_H
+
+#include "ns3/command-line.h"
+
+#include <cstdint>
+#include <string>
+
+namespace leach {
+
+// Scaling knobs and protocol policies shared by all basic-network variants.
+// The defaults reproduce the original hardcoded setup: 10 nodes on a diagonal
+// line, p = 0.2, 100 J per node and a 600 s run, with one member report per
+// second. Each variant presets the policies it was written for before parsing.
+struct SimulationConfig {
+    uint32_t numNodes = 10;
+    double fieldSize = 100.0;              // Side of the square sensor field (m)
+    double clusterHeadProbability = 0.2;
+    double duration = 600.0;               // Simulated seconds
+    double initialEnergy = 100.0;          // Per node (J)
+    std::string topology = "line";         // line | uniform | grid | clustered
+    uint32_t hotspots = 5;                 // Cluster centers for the clustered topology
+    double hotspotSpread = 10.0;           // Standard deviation around each center (m)
+    std::string mobility = "static";       // static | walk (random walk) | waypoint (random waypoint)
+    double nodeSpeed = 1.0;                // Speed of mobile sensors (m/s)
+    double hysteresis = 5.0;               // A moving member only switches to a head closer by this much (m)
+    double frameLength = 1.0;              // TDMA frame; each member reports once per frame (s)
+    uint32_t payloadBytes = 64;            // One member reading
+    double aggregationCorrelation = 1.0;   // 1 = readings fuse into one, 0 = concatenated
+    double uplinkCost = 0.2;               // DMS cost per power level of a head's fused uplink
+    std::string election = "probability";  // probability | threshold (LEACH T(n)) | energy (energy-weighted T(n))
+    std::string energyModel = "manual";    // manual | basic (BasicEnergySource + WifiRadioEnergyModel)
+    std::string powerPolicy = "dms";       // dms | priority
+    std::string radioModel = "dms";        // dms (fixed cost per power level) | firstorder
+    double radioElectronics = 50e-9;       // First-order E_elec (J/bit)
+    double radioFreeSpace = 10e-12;        // First-order eps_fs (J/bit/m^2)
+    double radioMultipath = 0.0013e-12;    // First-order eps_mp (J/bit/m^4)
+    bool abstractRadio = false;            // Skip Wi-Fi/IP; links are modelled by the loss/delay table
+    std::string linkBands = "50:0,100:0.02,150:0.1,250:0.5"; // Abstract loss per distance band, maxDistance:loss
+    double abstractDataRate = 1e6;         // Abstract link rate (bit/s)
+    double sinkX = 0.0;                    // Base station position; the line topology's first node (m)
+    double sinkY = 0.0;
+    std::string routing = "direct";        // direct | relay (cheapest-energy tree through nearer heads)
+    double minHeadEnergy = 10.0;           // Nodes with less cannot be elected (J)
+    bool backupHeads = false;              // Pick a successor per cluster and promote it when the head fails
+    double stopDeadFraction = 0.0;         // End the run once this fraction of nodes has died (0 = full duration, 1 = last death)
+    uint32_t threads = 1;                  // Threads for election and formation (0 = one per core); results match a serial run
+
+    // Register every knob with the variant's command line
+    void AddValues(ns3::CommandLine& cmd);
+};
+
+} // namespace leach
+
+#endif // LEACH_SIMULATION_CONFIG_H
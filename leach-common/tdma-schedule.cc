@@ -0,0 +1,23 @@
+#include "tdma-schedule.h"
+
+namespace leach {
+
+void TdmaSchedule::Build(const NodeStateTable& state, uint32_t numClusters) {
+    uint32_t n = state.GetN();
+    m_slot.assign(n, kNoSlot);
+    m_slotCount.assign(numClusters, 1); // The head's uplink slot
+
+    // Members take consecutive slots in ID order, counting up per cluster
+    for (uint32_t i = 0; i < n; ++i) {
+        if (state.role[i] == ROLE_MEMBER) {
+            m_slot[i] = m_slotCount[state.clusterIndex[i]]++ - 1;
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        if (state.role[i] == ROLE_CLUSTER_HEAD) {
+            m_slot[i] = m_slotCount[state.clusterIndex[i]] - 1;
+        }
+    }
+}
+
+} // namespace leach
@@ -0,0 +1,60 @@
+#ifndef LEACH_TDMA_SCHEDULE_H
+#define LEACH_TDMA_SCHEDULE_H
+
+#include "node-state-table.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// Slot layout of each cluster's TDMA frame, built by the heads once the
+// clusters are formed. A cluster with m members splits the frame into m + 1
+// equal slots: members get slots 0..m-1 in node ID order and the head's fused
+// uplink takes the last one. Members only need their radio during their own
+// slot and can sleep for the rest of the frame.
+class TdmaSchedule {
+public:
+    static constexpr uint32_t kNoSlot = NodeStateTable::kNone;
+
+    TdmaSchedule() : m_frameLength(1.0) {}
+
+    void SetFrameLength(double frameLength) {
+        m_frameLength = frameLength;
+    }
+
+    double GetFrameLength() const {
+        return m_frameLength;
+    }
+
+    // Assign slots from the roles and cluster indices in state
+    void Build(const NodeStateTable& state, uint32_t numClusters);
+
+    // Slot of a node in its cluster's frame; the head holds the last slot,
+    // unassigned nodes have kNoSlot
+    uint32_t GetSlot(uint32_t nodeId) const {
+        return m_slot[nodeId];
+    }
+
+    uint32_t GetSlotCount(uint32_t cluster) const {
+        return m_slotCount[cluster];
+    }
+
+    double GetSlotLength(uint32_t cluster) const {
+        return m_frameLength / m_slotCount[cluster];
+    }
+
+    // Start of a node's slot relative to the start of the frame (s)
+    double GetSlotOffset(uint32_t nodeId, uint32_t cluster) const {
+        return m_slot[nodeId] * GetSlotLength(cluster);
+    }
+
+private:
+    double m_frameLength;
+    std::vector<uint32_t> m_slot;      // Per node
+    std::vector<uint32_t> m_slotCount; // Per cluster, members + 1
+};
+
+} // namespace leach
+
+#endif // LEACH_TDMA_SCHEDULE_H
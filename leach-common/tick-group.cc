@@ -0,0 +1,76 @@
+#include "tick-group.h"
+
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+namespace leach {
+
+TickGroup::TickGroup(ProfiledEvent kind) : m_kind(kind), m_period(1.0), m_running(false) {}
+
+void TickGroup::SetPeriod(double seconds) {
+    m_period = seconds;
+}
+
+void TickGroup::SetCallback(TickCallback callback) {
+    m_callback = callback;
+}
+
+void TickGroup::Resize(uint32_t maxId) {
+    m_members.clear();
+    m_position.assign(maxId, kNotMember);
+    m_running = false;
+    m_event = ns3::EventId();
+}
+
+void TickGroup::Add(uint32_t id) {
+    if (Contains(id)) {
+        return;
+    }
+    m_position[id] = m_members.size();
+    m_members.push_back(id);
+}
+
+void TickGroup::Remove(uint32_t id) {
+    uint32_t position = m_position[id];
+    if (position == kNotMember) {
+        return;
+    }
+    uint32_t last = m_members.back();
+    m_members[position] = last;
+    m_position[last] = position;
+    m_members.pop_back();
+    m_position[id] = kNotMember;
+}
+
+void TickGroup::Clear() {
+    for (uint32_t id : m_members) {
+        m_position[id] = kNotMember;
+    }
+    m_members.clear();
+}
+
+void TickGroup::Start() {
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    Tick();
+}
+
+void TickGroup::Stop() {
+    m_running = false;
+    ns3::Simulator::Cancel(m_event);
+}
+
+void TickGroup::Tick() {
+    for (std::size_t i = 0; i < m_members.size();) {
+        uint32_t id = m_members[i];
+        m_callback(id);
+        if (i < m_members.size() && m_members[i] == id) {
+            ++i; // Otherwise the member removed itself and the last one took its slot
+        }
+    }
+    m_event = ns3::Simulator::Schedule(ns3::Seconds(m_period), Profiled(m_kind, &TickGroup::Tick, this));
+}
+
+} // namespace leach
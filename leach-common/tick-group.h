@@ -0,0 +1,66 @@
+#ifndef LEACH_TICK_GROUP_H
+#define LEACH_TICK_GROUP_H
+
+#include "profiler.h"
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace leach {
+
+// Members that all act once per period, driven by one self-rescheduling event
+// that walks them in a dense array. The event queue holds a single entry per
+// group however many members it has, and Add/Remove are O(1) through a
+// back-index: a removed member's slot is taken by the last one.
+class TickGroup {
+public:
+    // Receives the member ID
+    typedef ns3::Callback<void, uint32_t> TickCallback;
+
+    explicit TickGroup(ProfiledEvent kind);
+
+    void SetPeriod(double seconds);
+    void SetCallback(TickCallback callback);
+
+    // Size the back-index for IDs in [0, maxId), drop all members and forget
+    // any tick left over from a previous simulation
+    void Resize(uint32_t maxId);
+
+    void Add(uint32_t id);
+    void Remove(uint32_t id); // No-op if id is not a member
+    void Clear();
+
+    bool Contains(uint32_t id) const {
+        return m_position[id] != kNotMember;
+    }
+
+    uint32_t GetSize() const {
+        return static_cast<uint32_t>(m_members.size());
+    }
+
+    // Tick now and every period after; does nothing if already running
+    void Start();
+    void Stop();
+
+private:
+    static constexpr uint32_t kNotMember = 0xffffffff;
+
+    // A callback may remove the member it was called for; any other membership
+    // change should wait until the tick returns
+    void Tick();
+
+    ProfiledEvent m_kind;
+    double m_period;
+    TickCallback m_callback;
+    std::vector<uint32_t> m_members;  // Dense, in insertion order until a removal
+    std::vector<uint32_t> m_position; // Index in m_members per ID, or kNotMember
+    bool m_running;
+    ns3::EventId m_event;
+};
+
+} // namespace leach
+
+#endif // LEACH_TICK_GROUP_H
@@ -0,0 +1,102 @@
+#include "topology.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/pointer.h"
+#include "ns3/position-allocator.h"
+#include "ns3/rectangle.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace leach {
+
+namespace {
+
+ns3::Ptr<ns3::PositionAllocator> CreateClusteredAllocator(uint32_t numNodes, const SimulationConfig& config) {
+    ns3::Ptr<ns3::UniformRandomVariable> uniform = ns3::CreateObject<ns3::UniformRandomVariable>();
+    ns3::Ptr<ns3::NormalRandomVariable> normal = ns3::CreateObject<ns3::NormalRandomVariable>();
+    normal->SetAttribute("Mean", ns3::DoubleValue(0.0));
+    normal->SetAttribute("Variance", ns3::DoubleValue(config.hotspotSpread * config.hotspotSpread));
+
+    uint32_t hotspots = std::max(1u, config.hotspots);
+    std::vector<ns3::Vector> centers;
+    for (uint32_t c = 0; c < hotspots; ++c) {
+        centers.push_back(ns3::Vector(uniform->GetValue(0.0, config.fieldSize),
+                                      uniform->GetValue(0.0, config.fieldSize), 0.0));
+    }
+
+    ns3::Ptr<ns3::ListPositionAllocator> positions = ns3::CreateObject<ns3::ListPositionAllocator>();
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        const ns3::Vector& center = centers[uniform->GetInteger(0, hotspots - 1)];
+        double x = std::clamp(center.x + normal->GetValue(), 0.0, config.fieldSize);
+        double y = std::clamp(center.y + normal->GetValue(), 0.0, config.fieldSize);
+        positions->Add(ns3::Vector(x, y, 0.0));
+    }
+    return positions;
+}
+
+} // namespace
+
+void InstallTopology(const ns3::NodeContainer& nodes, const SimulationConfig& config) {
+    ns3::MobilityHelper mobility;
+    uint32_t n = nodes.GetN();
+
+    if (config.topology == "line") {
+        ns3::Ptr<ns3::ListPositionAllocator> positionAlloc = ns3::CreateObject<ns3::ListPositionAllocator>();
+        for (uint32_t i = 0; i < n; ++i) {
+            positionAlloc->Add(ns3::Vector(10.0 * i, 10.0 * i, 0.0));
+        }
+        mobility.SetPositionAllocator(positionAlloc);
+    } else if (config.topology == "uniform") {
+        std::string extent = "ns3::UniformRandomVariable[Min=0.0|Max=" + std::to_string(config.fieldSize) + "]";
+        mobility.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
+                                      "X", ns3::StringValue(extent),
+                                      "Y", ns3::StringValue(extent));
+    } else if (config.topology == "grid") {
+        uint32_t columns = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(n)))));
+        double spacing = columns > 1 ? config.fieldSize / (columns - 1) : 0.0;
+        mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                      "MinX", ns3::DoubleValue(0.0),
+                                      "MinY", ns3::DoubleValue(0.0),
+                                      "DeltaX", ns3::DoubleValue(spacing),
+                                      "DeltaY", ns3::DoubleValue(spacing),
+                                      "GridWidth", ns3::UintegerValue(columns),
+                                      "LayoutType", ns3::StringValue("RowFirst"));
+    } else if (config.topology == "clustered") {
+        mobility.SetPositionAllocator(CreateClusteredAllocator(n, config));
+    } else {
+        NS_FATAL_ERROR("Unknown topology '" << config.topology << "'; expected line, uniform, grid or clustered");
+    }
+
+    // Mobile sensors start where the topology placed them and stay inside its extent
+    double extent = config.topology == "line" ? 10.0 * (n > 0 ? n - 1 : 0) : config.fieldSize;
+    std::string speed = "ns3::ConstantRandomVariable[Constant=" + std::to_string(config.nodeSpeed) + "]";
+    if (config.mobility == "static") {
+        mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    } else if (config.mobility == "walk") {
+        mobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                                  "Bounds", ns3::RectangleValue(ns3::Rectangle(0.0, extent, 0.0, extent)),
+                                  "Speed", ns3::StringValue(speed));
+    } else if (config.mobility == "waypoint") {
+        std::string range = "ns3::UniformRandomVariable[Min=0.0|Max=" + std::to_string(extent) + "]";
+        ns3::Ptr<ns3::RandomRectanglePositionAllocator> waypoints = ns3::CreateObject<ns3::RandomRectanglePositionAllocator>();
+        waypoints->SetAttribute("X", ns3::StringValue(range));
+        waypoints->SetAttribute("Y", ns3::StringValue(range));
+        mobility.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                                  "Speed", ns3::StringValue(speed),
+                                  "Pause", ns3::StringValue("ns3::ConstantRandomVariable[Constant=0.0]"),
+                                  "PositionAllocator", ns3::PointerValue(waypoints));
+    } else {
+        NS_FATAL_ERROR("Unknown mobility '" << config.mobility << "'; expected static, walk or waypoint");
+    }
+    mobility.Install(nodes);
+}
+
+} // namespace leach
@@ -0,0 +1,22 @@
+#ifndef LEACH_TOPOLOGY_H
+#define LEACH_TOPOLOGY_H
+
+#include "simulation-config.h"
+
+#include "ns3/node-container.h"
+
+namespace leach {
+
+// Place the nodes according to config.topology:
+//   line      - the original (10 i, 10 i) diagonal, independent of fieldSize
+//   uniform   - uniformly random over the field
+//   grid      - a square grid spanning the field
+//   clustered - Gaussian hotspots around uniformly placed centers
+// and install the config.mobility model on them: ConstantPositionMobilityModel
+// for static, or a random walk / random waypoint at config.nodeSpeed bounded
+// by the topology's extent.
+void InstallTopology(const ns3::NodeContainer& nodes, const SimulationConfig& config);
+
+} // namespace leach
+
+#endif // LEACH_TOPOLOGY_H
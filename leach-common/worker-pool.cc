@@ -0,0 +1,90 @@
+#include "worker-pool.h"
+
+#include <algorithm>
+
+namespace leach {
+
+WorkerPool::WorkerPool()
+    : m_task(nullptr),
+      m_n(0),
+      m_generation(0),
+      m_pending(0),
+      m_stopping(false) {}
+
+WorkerPool::~WorkerPool() {
+    StopThreads();
+}
+
+void WorkerPool::SetThreadCount(uint32_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == GetThreadCount()) {
+        return;
+    }
+    StopThreads();
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = m_generation; // Read before any thread can miss a later Run
+    }
+    for (uint32_t chunk = 1; chunk < threads; ++chunk) {
+        m_threads.emplace_back(&WorkerPool::Work, this, chunk, generation);
+    }
+}
+
+uint32_t WorkerPool::Run(uint32_t n, const Task& task) {
+    if (m_threads.empty()) {
+        task(0, 0, n);
+        return 1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_n = n;
+        m_pending = static_cast<uint32_t>(m_threads.size());
+        m_generation++;
+    }
+    m_start.notify_all();
+    task(0, 0, ChunkBegin(1));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_pending == 0; });
+    m_task = nullptr;
+    return GetThreadCount();
+}
+
+void WorkerPool::Work(uint32_t chunk, uint64_t seen) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_start.wait(lock, [this, seen]() { return m_stopping || m_generation != seen; });
+        if (m_stopping) {
+            return;
+        }
+        seen = m_generation;
+        const Task& task = *m_task;
+        uint32_t begin = ChunkBegin(chunk);
+        uint32_t end = ChunkBegin(chunk + 1);
+        lock.unlock();
+        task(chunk, begin, end);
+        lock.lock();
+        if (--m_pending == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::StopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_start.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+    m_stopping = false;
+}
+
+} // namespace leach
@@ -0,0 +1,62 @@
+#ifndef LEACH_WORKER_POOL_H
+#define LEACH_WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace leach {
+
+// Persistent threads for the engine's per-node loops. Run splits [0, n) into
+// one contiguous chunk per thread, numbered in ID order, and blocks until all
+// of them are done; the calling thread takes chunk 0. Results appended per
+// chunk and merged in chunk order come out in the order of a serial loop.
+// Threads start on the first SetThreadCount above 1, so a process can still
+// fork before that.
+class WorkerPool {
+public:
+    // Receives the chunk number and its half-open range [begin, end)
+    typedef std::function<void(uint32_t chunk, uint32_t begin, uint32_t end)> Task;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Threads in total, counting the caller's; 0 = one per core, 1 = run inline
+    void SetThreadCount(uint32_t threads);
+
+    uint32_t GetThreadCount() const {
+        return static_cast<uint32_t>(m_threads.size()) + 1;
+    }
+
+    // Call task once per chunk of [0, n); returns the number of chunks
+    uint32_t Run(uint32_t n, const Task& task);
+
+private:
+    // seen = the last generation finished before this thread was started
+    void Work(uint32_t chunk, uint64_t seen);
+    void StopThreads();
+
+    uint32_t ChunkBegin(uint32_t chunk) const {
+        return static_cast<uint32_t>(static_cast<uint64_t>(m_n) * chunk / GetThreadCount());
+    }
+
+    std::vector<std::thread> m_threads; // Worker i runs chunk i + 1
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const Task* m_task;   // The running job; valid while m_pending > 0
+    uint32_t m_n;
+    uint64_t m_generation; // Bumped for every job so each worker takes it once
+    uint32_t m_pending;    // Workers still on the current job
+    bool m_stopping;
+};
+
+} // namespace leach
+
+#endif // LEACH_WORKER_POOL_H